@@ -0,0 +1,15 @@
+#ifndef ANSI_H
+#define ANSI_H
+
+// Escape di colore interpretati da term_printf() (vedi term.c)
+#define C_RST  "\x1b[0m"
+#define C_RED  "\x1b[31m"
+#define C_GRN  "\x1b[32m"
+#define C_YLW  "\x1b[33m"
+#define C_BLU  "\x1b[34m"
+#define C_MAG  "\x1b[35m"
+#define C_CYN  "\x1b[36m"
+#define C_WHT  "\x1b[37m"
+#define C_BLD  "\x1b[1m"
+
+#endif
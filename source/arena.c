@@ -0,0 +1,24 @@
+#include "arena.h"
+
+void arena_init(Arena *a, void *mem, u32 size) {
+    a->base  = (u8*)mem;
+    a->size  = mem ? size : 0;
+    a->used  = 0;
+    a->peak  = 0;
+    a->fails = 0;
+}
+
+void arena_reset(Arena *a) {
+    a->used = 0;
+}
+
+void *arena_alloc(Arena *a, u32 size) {
+    u32 at = (a->used + ARENA_ALIGN - 1) & ~(u32)(ARENA_ALIGN - 1);
+    if (at > a->size || size > a->size - at) {
+        a->fails++;
+        return NULL;
+    }
+    a->used = at + size;
+    if (a->used > a->peak) a->peak = a->used;
+    return a->base + at;
+}
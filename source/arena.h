@@ -0,0 +1,26 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "platform.h"
+
+// Memoria di lavoro a pila: le allocazioni avanzano un indice in un
+// blocco fisso e si liberano tutte insieme con arena_reset(). Il blocco
+// e' di chi chiama; l'arena tiene solo il massimo raggiunto e le
+// richieste rifiutate perche' non c'era spazio.
+
+#define ARENA_ALIGN  8
+
+typedef struct {
+    u8  *base;
+    u32  size;
+    u32  used;
+    u32  peak;     // massimo di used dall'ultimo arena_init()
+    u32  fails;
+} Arena;
+
+void  arena_init(Arena *a, void *mem, u32 size);
+void  arena_reset(Arena *a);
+// Blocco allineato ad ARENA_ALIGN, NULL se non ci sta
+void *arena_alloc(Arena *a, u32 size);
+
+#endif
@@ -0,0 +1,165 @@
+#include "cache.h"
+#include "platform.h"
+#include "snapshot.h"
+#include "tz.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+// File: "WXC2", istante del download (8 byte little-endian), snapshot
+#define CACHE_MAGIC     "WXC2"
+#define CACHE_HDR_SIZE  12
+
+static int cacheTtl = CACHE_TTL_DEFAULT;
+
+// La cache si usa dal thread principale e dal prefetch: letture e
+// scritture passano da cacheLock, che protegge anche il buffer del file
+// e il WeatherData di lavoro (statici per non pesare sullo stack del
+// thread di prefetch)
+static LightLock     cacheLock;
+static unsigned char cacheBuf[CACHE_HDR_SIZE + SNAPSHOT_MAX_SIZE];
+static WeatherData   cacheData;
+
+// ── Configurazione ────────────────────────────────────────────────────────
+// cache.txt contiene la durata di validita' in minuti (0 = sempre vecchi)
+void cache_init(void) {
+    LightLock_Init(&cacheLock);
+    mkdir(CACHE_DIR, 0777);
+    FILE *f = fopen(CACHE_CFG_FILE, "r");
+    if (!f) return;
+    int minutes = 0;
+    if (fscanf(f, "%d", &minutes) == 1) cache_set_ttl(minutes * 60);
+    fclose(f);
+}
+
+void cache_set_ttl(int seconds) {
+    cacheTtl = seconds < 0 ? 0 : seconds;
+}
+
+int cache_ttl(void) {
+    return cacheTtl;
+}
+
+// ── Scadenza per blocco ───────────────────────────────────────────────────
+// La durata di cache.txt vale per la corrente; le previsioni cambiano
+// poche volte al giorno e durano CACHE_TTL_HOURLY e CACHE_TTL_DAILY
+// volte tanto. Le serie scadono anche al cambio di data locale, perche'
+// partono dalla mezzanotte di oggi.
+static const int ttlScale[WEATHER_BLOCKS] = {
+    1, CACHE_TTL_HOURLY, CACHE_TTL_DAILY
+};
+
+unsigned cache_expired(const WeatherData *w, time_t now) {
+    unsigned due = 0;
+    for (int b = 0; b < WEATHER_BLOCKS; b++) {
+        unsigned bit = 1u << b;
+        if (!(w->blocks & bit)) continue;
+        // Eta' negativa: orologio spostato indietro
+        long age = weather_age(w, bit, now);
+        if (age < 0 || age >= (long)cacheTtl * ttlScale[b]) due |= bit;
+    }
+
+    // Data locale di adesso con l'offset dell'ultima corrente
+    char today[20];
+    tz_format_iso((s64)now + w->utc_offset, today, sizeof(today));
+    if (w->daily_date[0][0] && strncmp(w->daily_date[0], today, 10) != 0)
+        due |= w->blocks & (WEATHER_HOURLY | WEATHER_DAILY);
+    return due;
+}
+
+unsigned cache_due(const WeatherData *w, time_t now) {
+    return cache_expired(w, now) | (WEATHER_ALL & ~w->blocks);
+}
+
+CacheState cache_state(const WeatherData *w, time_t now) {
+    if (!w->valid) return CACHE_MISS;
+    return cache_due(w, now) ? CACHE_STALE : CACHE_FRESH;
+}
+
+// ── Chiave: hash FNV-1a di lat/lon/timezone ───────────────────────────────
+static void cache_path(const City *c, char *path, int maxlen) {
+    char key[96];
+    snprintf(key, sizeof(key), "%.4f|%.4f|%s", c->lat, c->lon, c->timezone);
+    unsigned int h = 2166136261u;
+    for (const char *p = key; *p; p++) {
+        h ^= (unsigned char)*p;
+        h *= 16777619u;
+    }
+    snprintf(path, maxlen, CACHE_DIR "/%08x.bin", h);
+}
+
+// ── Lettura / scrittura ───────────────────────────────────────────────────
+// Legge in cacheData il file della citta'; da chiamare con cacheLock
+static bool cache_read(const City *c) {
+    char path[64];
+    cache_path(c, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    int len = (int)fread(cacheBuf, 1, sizeof(cacheBuf), f);
+    fclose(f);
+    if (len < CACHE_HDR_SIZE || memcmp(cacheBuf, CACHE_MAGIC, 4) != 0)
+        return false;
+    if (snapshot_decode(cacheBuf + CACHE_HDR_SIZE, len - CACHE_HDR_SIZE,
+                        &cacheData) != 0)
+        return false;
+    weather_sun(c, &cacheData);
+    return true;
+}
+
+CacheState cache_load(const City *c, WeatherData *out, time_t *when) {
+    LightLock_Lock(&cacheLock);
+    bool ok = cache_read(c);
+    long long fetched = 0;
+    if (ok) {
+        for (int i = 7; i >= 0; i--)
+            fetched = (fetched << 8) | cacheBuf[4 + i];
+        *out = cacheData;
+    }
+    LightLock_Unlock(&cacheLock);
+    if (!ok) return CACHE_MISS;
+
+    if (when) *when = (time_t)fetched;
+    return cache_state(out, time(NULL)) == CACHE_FRESH
+           ? CACHE_FRESH : CACHE_STALE;
+}
+
+// Con solo alcuni blocchi si tengono gli altri gia' salvati, ognuno con
+// la sua ora di download. Il file si scrive accanto e poi si rinomina:
+// un'interruzione a meta' lascia quello vecchio. Sulla SD rename() non
+// sovrascrive, quindi al secondo tentativo si toglie prima il vecchio.
+void cache_store(const City *c, const WeatherData *w) {
+    if (!w->valid) return;
+
+    LightLock_Lock(&cacheLock);
+    if ((w->blocks & WEATHER_ALL) != WEATHER_ALL && cache_read(c)) {
+        weather_merge(&cacheData, w);
+        w = &cacheData;
+    }
+
+    int len = snapshot_encode(w, cacheBuf + CACHE_HDR_SIZE,
+                              SNAPSHOT_MAX_SIZE);
+    if (len >= 0) {
+        long long now = (long long)time(NULL);
+        memcpy(cacheBuf, CACHE_MAGIC, 4);
+        for (int i = 0; i < 8; i++)
+            cacheBuf[4 + i] = (unsigned char)(now >> (8 * i));
+
+        char path[64], tmp[68];
+        cache_path(c, path, sizeof(path));
+        snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+        FILE *f = fopen(tmp, "wb");
+        if (f) {
+            bool ok = fwrite(cacheBuf, 1, CACHE_HDR_SIZE + len, f)
+                      == (size_t)(CACHE_HDR_SIZE + len);
+            ok = fclose(f) == 0 && ok;
+            if (ok && rename(tmp, path) != 0) {
+                remove(path);
+                ok = rename(tmp, path) == 0;
+            }
+            if (!ok) remove(tmp);
+        }
+    }
+    LightLock_Unlock(&cacheLock);
+}
@@ -0,0 +1,33 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <time.h>
+#include "weather.h"
+#include "cities.h"
+
+#define CACHE_DIR          "/3ds/3ds-weather/cache"
+#define CACHE_CFG_FILE     "/3ds/3ds-weather/cache.txt"
+#define CACHE_TTL_DEFAULT  (30 * 60)   // corrente; vedi cache_expired()
+#define CACHE_TTL_HOURLY   4             // volte la durata della corrente
+#define CACHE_TTL_DAILY    12
+
+typedef enum {
+    CACHE_MISS = 0,
+    CACHE_FRESH,
+    CACHE_STALE
+} CacheState;
+
+void       cache_init(void);
+void       cache_set_ttl(int seconds);
+int        cache_ttl(void);
+// FRESH solo con tutti i blocchi e nessuno scaduto
+CacheState cache_load(const City *c, WeatherData *out, time_t *fetched);
+void       cache_store(const City *c, const WeatherData *w);
+
+// Blocchi presenti in w ma scaduti in now, e questi piu' quelli che
+// mancano: quanto chiedere al prossimo aggiornamento
+unsigned   cache_expired(const WeatherData *w, time_t now);
+unsigned   cache_due(const WeatherData *w, time_t now);
+CacheState cache_state(const WeatherData *w, time_t now);
+
+#endif
@@ -0,0 +1,305 @@
+#include "chart.h"
+#include "render.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RGB565(r, g, b)  ((u16)((((r) >> 3) << 11) | (((g) >> 2) << 5) \
+                                | ((b) >> 3)))
+
+#define FX_ONE   (1 << CHART_FX)
+#define FX_HALF  (FX_ONE >> 1)
+
+#define COL_BG        RGB565(  0,   0,   0)
+#define COL_AXIS      RGB565(128, 128, 128)
+#define COL_GRID      RGB565( 56,  56,  56)
+#define COL_MARK      RGB565(112, 112, 112)
+#define COL_TEMP      RGB565(255, 224,   0)
+#define COL_TEMP_AREA RGB565( 72,  56,   0)
+#define COL_RAIN      RGB565( 32,  96, 255)
+#define COL_MAX       RGB565(255,  96,  64)
+#define COL_MIN       RGB565( 64, 192, 255)
+#define COL_BAND      RGB565( 56,  32,  64)
+
+static u16 *fb;
+static int  fbCols;
+static int  fbWidth;
+
+void chart_target(u16 *target, int cols) {
+    fb      = target;
+    fbCols  = cols;
+    fbWidth = cols * 8;
+}
+
+// ── Pixel ─────────────────────────────────────────────────────────────────
+// Framebuffer ruotato: la colonna x e' contigua, dal basso verso l'alto
+static inline u16 *pix(int x, int y) {
+    return fb + x * RENDER_FB_HEIGHT + (RENDER_FB_HEIGHT - 1 - y);
+}
+
+// d + (s - d) * a / 32 sui tre canali insieme: verde spostato nella
+// meta' alta della parola, cosi' ogni canale ha 5 bit di margine
+static inline u16 blend(u16 d, u16 s, u32 a) {
+    u32 dd = (d | ((u32)d << 16)) & 0x07E0F81F;
+    u32 ss = (s | ((u32)s << 16)) & 0x07E0F81F;
+    u32 r  = ((((ss - dd) * a) >> 5) + dd) & 0x07E0F81F;
+    return (u16)(r | (r >> 16));
+}
+
+// a = copertura 0-32
+static inline void plot(int x, int y, u16 color, u32 a) {
+    if (x < 0 || x >= fbWidth || y < 0 || y >= RENDER_FB_HEIGHT || !a)
+        return;
+    u16 *p = pix(x, y);
+    *p = (a >= 32) ? color : blend(*p, color, a);
+}
+
+void chart_span(int x, int y0, int y1, u16 color) {
+    if (!fb || x < 0 || x >= fbWidth) return;
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    if (y0 < 0) y0 = 0;
+    if (y1 >= RENDER_FB_HEIGHT) y1 = RENDER_FB_HEIGHT - 1;
+    // y crescente = indirizzi decrescenti: si parte dal basso
+    u16 *p = pix(x, y1);
+    for (int n = y1 - y0 + 1; n > 0; n--) *p++ = color;
+}
+
+// ── Linee ─────────────────────────────────────────────────────────────────
+// Xiaolin Wu: per ogni colonna (riga se la linea e' ripida) i due pixel
+// attorno alla y esatta, con copertura proporzionale alla distanza.
+// y in 16.16 lungo la linea, passo = pendenza.
+void chart_line(s32 x0, s32 y0, s32 x1, s32 y1, u16 color) {
+    if (!fb) return;
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    s32 t;
+    if (steep) {
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+
+    s32 dx   = x1 - x0;
+    s32 grad = dx ? (s32)(((s64)(y1 - y0) << 16) / dx) : 0;
+    int xs   = x0 >> CHART_FX;
+    int xe   = x1 >> CHART_FX;
+    // y al centro della prima colonna, meno mezzo pixel: la parte intera
+    // e' il pixel sopra, la frazione la copertura di quello sotto
+    s32 y = (y0 << (16 - CHART_FX))
+          + (s32)(((s64)grad * ((xs << CHART_FX) + FX_HALF - x0))
+                  >> CHART_FX)
+          - 0x8000;
+
+    for (int x = xs; x <= xe; x++, y += grad) {
+        int yi = y >> 16;
+        u32 f  = ((u32)y >> 11) & 31;
+        if (steep) {
+            plot(yi,     x, color, 32 - f);
+            plot(yi + 1, x, color, f);
+        } else {
+            plot(x, yi,     color, 32 - f);
+            plot(x, yi + 1, color, f);
+        }
+    }
+}
+
+// ── Costruzione ───────────────────────────────────────────────────────────
+static int tenths(float v) {
+    return (int)(v * 10.f + (v < 0 ? -0.5f : 0.5f));
+}
+
+static int floor_div(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static void layout(Chart *c, int row, int rows, int n) {
+    if (n > CHART_MAX_PTS) n = CHART_MAX_PTS;
+    if (n < 0)             n = 0;
+    memset(c, 0, sizeof(*c));
+    c->row    = row;
+    c->rows   = rows;
+    c->cols   = fbCols;
+    c->n      = n;
+    c->mark   = -1;
+    // Etichette della scala al centro della prima e dell'ultima riga
+    // dei dati, l'ultima riga del rettangolo e' per quelle dei punti
+    c->left   = 4 * 8 + 1;
+    c->right  = fbCols * 8 - 4;
+    c->top    = row * 8 + 4;
+    c->bottom = (row + rows - 2) * 8 + 4;
+
+    s32 step = n ? ((c->right - c->left) << CHART_FX) / n : 0;
+    for (int i = 0; i < n; i++)
+        c->px[i] = (c->left << CHART_FX) + step * i + step / 2;
+}
+
+// Scala a passi di 5 gradi che contiene lo..hi (in decimi)
+static void scale(Chart *c, int *lo, int *hi) {
+    *lo = floor_div(*lo, 50) * 50;
+    *hi = -floor_div(-*hi, 50) * 50;
+    if (*hi <= *lo) *hi = *lo + 50;
+
+    int midRow = (c->rows - 2) / 2;
+    int mid    = *hi - (*hi - *lo) * midRow / (c->rows - 2);
+    snprintf(c->ylab[0], CHART_LABEL, "%3d", *hi / 10);
+    snprintf(c->ylab[1], CHART_LABEL, "%3d", floor_div(mid + 5, 10));
+    snprintf(c->ylab[2], CHART_LABEL, "%3d", *lo / 10);
+}
+
+static s32 map_y(const Chart *c, int v, int lo, int hi) {
+    return (c->top << CHART_FX) + FX_HALF
+         + (s32)((s64)(hi - v) * ((c->bottom - c->top) << CHART_FX)
+                 / (hi - lo));
+}
+
+void chart_hourly(Chart *c, const WeatherData *w, int first, int count,
+                  int row, int rows) {
+    if (first < 0) first = 0;
+    if (count > w->hourly_count - first) count = w->hourly_count - first;
+    layout(c, row, rows, count);
+    if (c->n == 0) return;
+
+    int lo = tenths(w->hourly_temp[first]), hi = lo;
+    int pmax = 20;    // almeno 2 mm di fondo scala
+    for (int i = 0; i < c->n; i++) {
+        int t = tenths(w->hourly_temp[first + i]);
+        int p = tenths(w->hourly_precip[first + i]);
+        if (t < lo) lo = t;
+        if (t > hi) hi = t;
+        if (p > pmax) pmax = p;
+    }
+    pmax = (pmax + 9) / 10 * 10;
+    scale(c, &lo, &hi);
+    snprintf(c->rain, sizeof(c->rain), "%dmm", pmax / 10);
+
+    // Le barre occupano al massimo la meta' bassa
+    int barMax = (c->bottom - c->top) / 2;
+    for (int i = 0; i < c->n; i++) {
+        int h = first + i;
+        int p = tenths(w->hourly_precip[h]);
+        c->ya[i]  = map_y(c, tenths(w->hourly_temp[h]), lo, hi);
+        c->bar[i] = (s16)((p > 0 ? p : 0) * barMax / pmax);
+        if (h == w->current_hour) c->mark = i;
+        if (h % 6 == 0) snprintf(c->xlab[i], 3, "%02d", h % 24);
+    }
+}
+
+void chart_daily(Chart *c, const WeatherData *w, int row, int rows) {
+    layout(c, row, rows, FORECAST_DAYS);
+    c->daily = true;
+
+    int lo = tenths(w->daily_min[0]), hi = tenths(w->daily_max[0]);
+    for (int i = 0; i < c->n; i++) {
+        int mn = tenths(w->daily_min[i]), mx = tenths(w->daily_max[i]);
+        if (mn < lo) lo = mn;
+        if (mx > hi) hi = mx;
+    }
+    scale(c, &lo, &hi);
+
+    for (int i = 0; i < c->n; i++) {
+        c->ya[i] = map_y(c, tenths(w->daily_max[i]), lo, hi);
+        c->yb[i] = map_y(c, tenths(w->daily_min[i]), lo, hi);
+        const char *d = w->daily_date[i];
+        if (strlen(d) >= 10) { c->xlab[i][0] = d[8]; c->xlab[i][1] = d[9]; }
+    }
+}
+
+// ── Disegno ───────────────────────────────────────────────────────────────
+// Ordinata della spezzata ys al centro della colonna x del segmento i
+static inline s32 seg_y(const Chart *c, const s32 *ys, int i, int x) {
+    s32 t = (x << CHART_FX) + FX_HALF - c->px[i];
+    return ys[i] + (s32)((s64)(ys[i + 1] - ys[i]) * t
+                         / (c->px[i + 1] - c->px[i]));
+}
+
+// Colonne piene tra la spezzata ya e yb (o il fondo se yb e' NULL)
+static void fill_between(const Chart *c, const s32 *ya, const s32 *yb,
+                         u16 color) {
+    for (int i = 0; i + 1 < c->n; i++) {
+        int xs = c->px[i] >> CHART_FX;
+        int xe = c->px[i + 1] >> CHART_FX;
+        for (int x = xs; x < xe; x++) {
+            int y0 = (seg_y(c, ya, i, x) + FX_HALF) >> CHART_FX;
+            int y1 = yb ? (seg_y(c, yb, i, x) + FX_HALF) >> CHART_FX
+                        : c->bottom - 1;
+            chart_span(x, y0, y1, color);
+        }
+    }
+}
+
+static void polyline(const Chart *c, const s32 *ys, u16 color) {
+    for (int i = 0; i + 1 < c->n; i++)
+        chart_line(c->px[i], ys[i], c->px[i + 1], ys[i + 1], color);
+}
+
+static void dotted_row(const Chart *c, int y) {
+    for (int x = c->left; x < c->right; x += 2)
+        plot(x, y, COL_GRID, 32);
+}
+
+void chart_draw(const Chart *c) {
+    if (!fb) return;
+    PROF_SCOPE(PROF_CHART);
+    int y0 = c->row * 8, y1 = (c->row + c->rows) * 8 - 1;
+    for (int x = 0; x < fbWidth; x++)
+        chart_span(x, y0, y1, COL_BG);
+    if (c->n == 0) return;
+
+    // Griglia ai valori delle etichette, assi
+    int mid = c->top + (c->rows - 2) / 2 * 8;
+    dotted_row(c, c->top);
+    dotted_row(c, mid);
+    chart_span(c->left - 1, c->top, c->bottom, COL_AXIS);
+    for (int x = c->left - 1; x < c->right; x++)
+        plot(x, c->bottom, COL_AXIS, 32);
+
+    if (c->daily) {
+        fill_between(c, c->ya, c->yb, COL_BAND);
+        polyline(c, c->ya, COL_MAX);
+        polyline(c, c->yb, COL_MIN);
+        for (int i = 0; i < c->n; i++) {
+            int x = c->px[i] >> CHART_FX;
+            int ya = c->ya[i] >> CHART_FX, yb = c->yb[i] >> CHART_FX;
+            for (int k = -1; k <= 1; k++) {
+                chart_span(x + k, ya - 1, ya + 1, COL_MAX);
+                chart_span(x + k, yb - 1, yb + 1, COL_MIN);
+            }
+        }
+    } else {
+        fill_between(c, c->ya, NULL, COL_TEMP_AREA);
+
+        int half = ((c->px[1 % c->n] - c->px[0]) >> CHART_FX) / 2 - 1;
+        if (half < 1) half = 1;
+        for (int i = 0; i < c->n; i++) {
+            if (c->bar[i] <= 0) continue;
+            int x = c->px[i] >> CHART_FX;
+            for (int k = -half + 1; k < half; k++)
+                chart_span(x + k, c->bottom - c->bar[i], c->bottom - 1,
+                           COL_RAIN);
+        }
+        if (c->mark >= 0) {
+            int x = c->px[c->mark] >> CHART_FX;
+            for (int y = c->top; y < c->bottom; y += 2)
+                plot(x, y, COL_MARK, 32);
+        }
+        polyline(c, c->ya, COL_TEMP);
+    }
+
+    // Etichette gia' pronte, nelle celle fuori dall'area dei dati
+    render_target(fb, fbCols, RENDER_FB_HEIGHT / 8);
+    int lrow = c->row + c->rows - 1;
+    render_text(0, c->row,                      c->ylab[0], 3, RC_WHITE);
+    render_text(0, c->row + (c->rows - 2) / 2,  c->ylab[1], 3, RC_WHITE);
+    render_text(0, c->row + c->rows - 2,        c->ylab[2], 3, RC_WHITE);
+    if (!c->daily)
+        render_text(0, lrow, c->rain, strlen(c->rain), RC_BLUE | RC_BRIGHT);
+    for (int i = 0; i < c->n; i++) {
+        if (!c->xlab[i][0]) continue;
+        int col = (c->px[i] >> CHART_FX) / 8;
+        if (col > c->cols - 2) col = c->cols - 2;
+        render_text(col, lrow, c->xlab[i], 2, RC_WHITE);
+    }
+}
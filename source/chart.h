@@ -0,0 +1,54 @@
+#ifndef CHART_H
+#define CHART_H
+
+#include "platform.h"
+#include "weather.h"
+
+// Grafici disegnati in software nel framebuffer RGB565 dello schermo
+// inferiore: temperatura oraria (linea antialiasata con area sotto) e
+// pioggia (barre), minime e massime dei giorni (fascia tra due linee).
+// Le coordinate sono in virgola fissa con CHART_FX bit frazionari; le
+// aree si riempiono per colonne, che nel framebuffer ruotato del 3DS
+// sono contigue in memoria. Le etichette degli assi si preparano una
+// volta in chart_hourly()/chart_daily() e chart_draw() le copia soltanto.
+
+#define CHART_FX       8
+#define CHART_MAX_PTS  48
+#define CHART_LABEL    12
+
+typedef struct {
+    // Rettangolo in celle da 8x8: colonne 0-3 per le etichette della
+    // scala, ultima riga per quelle dei punti
+    int  row, rows, cols;
+    // Area dei dati in pixel (y verso il basso)
+    int  left, right, top, bottom;
+
+    bool daily;
+    int  n;
+    s32  px[CHART_MAX_PTS];     // ascissa dei punti
+    s32  ya[CHART_MAX_PTS];     // temperatura oraria o massima
+    s32  yb[CHART_MAX_PTS];     // minima (solo giornaliero)
+    s16  bar[CHART_MAX_PTS];    // altezza delle barre pioggia in pixel
+    int  mark;                  // punto dell'ora corrente, -1 se fuori
+
+    char ylab[3][CHART_LABEL];  // scala: alto, meta', basso
+    char xlab[CHART_MAX_PTS][3];
+    char rain[CHART_LABEL + 2]; // fondo scala della pioggia ("4mm")
+} Chart;
+
+// Framebuffer ruotato alto RENDER_FB_HEIGHT pixel, cols celle di larghezza
+void chart_target(u16 *fb, int cols);
+
+// count ore da first (al massimo CHART_MAX_PTS) nelle righe di celle
+// da row a row+rows-1
+void chart_hourly(Chart *c, const WeatherData *w, int first, int count,
+                  int row, int rows);
+void chart_daily(Chart *c, const WeatherData *w, int row, int rows);
+// Ridisegna tutto il rettangolo del grafico, sfondo compreso
+void chart_draw(const Chart *c);
+
+// Primitive: linea antialiasata (Wu) e colonna piena da y0 a y1 inclusi
+void chart_line(s32 x0, s32 y0, s32 x1, s32 y1, u16 color);
+void chart_span(int x, int y0, int y1, u16 color);
+
+#endif
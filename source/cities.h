@@ -3,7 +3,9 @@
 
 #define MAX_CITIES     20
 #define CITY_NAME_LEN  48
+#ifndef CITIES_FILE
 #define CITIES_FILE    "/3ds/3ds-weather/cities.txt"
+#endif
 #define LANG_FILE      "/3ds/3ds-weather/lang.txt"
 
 typedef struct {
@@ -0,0 +1,58 @@
+#include "fetch.h"
+#include <string.h>
+
+#define FETCH_STACK  (32 * 1024)
+
+// ── Job asincrono ─────────────────────────────────────────────────────────
+static void fetch_main(void *arg) {
+    FetchJob *job = (FetchJob*)arg;
+    job->result = weather_fetch_blocks(&job->city, job->blocks,
+                                       &job->data, &job->ctl);
+    job->state = JOB_DONE;
+}
+
+bool fetch_start(FetchJob *job, const City *c, unsigned blocks) {
+    fetch_abort(job);
+    job->city   = *c;
+    job->blocks = blocks;
+    job->result = -1;
+    fetchctl_init(&job->ctl);
+
+    s32 prio = 0x30;
+    svcGetThreadPriority(&prio, CUR_THREAD_HANDLE);
+    job->state  = JOB_RUNNING;
+    job->thread = threadCreate(fetch_main, job, FETCH_STACK,
+                               prio + 1, -2, false);
+    if (!job->thread) {
+        job->state = JOB_DONE;
+        return false;
+    }
+    return true;
+}
+
+bool fetch_done(const FetchJob *job) {
+    return job->state == JOB_DONE;
+}
+
+// Attende la fine del thread e ritorna il risultato di weather_fetch
+int fetch_finish(FetchJob *job) {
+    if (job->state == JOB_IDLE) return job->result;
+    if (job->thread) {
+        threadJoin(job->thread, U64_MAX);
+        threadFree(job->thread);
+        job->thread = NULL;
+    }
+    job->state  = JOB_IDLE;
+    return job->result;
+}
+
+void fetch_cancel(FetchJob *job) {
+    if (job->state == JOB_RUNNING) fetchctl_cancel(&job->ctl);
+}
+
+// Annulla e attende: dopo la chiamata il job e' di nuovo libero
+void fetch_abort(FetchJob *job) {
+    if (job->state == JOB_IDLE) return;
+    fetch_cancel(job);
+    fetch_finish(job);
+}
@@ -0,0 +1,35 @@
+#ifndef FETCH_H
+#define FETCH_H
+
+#include <3ds.h>
+#include "weather.h"
+#include "transport.h"
+#include "cities.h"
+
+// Download di una citta' su un thread separato: il ciclo principale
+// continua a disegnare e leggere i tasti, e controlla fetch_done() a
+// ogni frame. Il job scarica solo i blocchi chiesti (WEATHER_*): data
+// va unito con weather_merge() ai dati gia' mostrati.
+typedef enum {
+    JOB_IDLE = 0,
+    JOB_RUNNING,
+    JOB_DONE
+} JobState;
+
+typedef struct {
+    City              city;
+    unsigned          blocks;
+    WeatherData       data;
+    int               result;
+    FetchCtl          ctl;
+    Thread            thread;
+    volatile JobState state;
+} FetchJob;
+
+bool fetch_start(FetchJob *job, const City *c, unsigned blocks);
+bool fetch_done(const FetchJob *job);
+int  fetch_finish(FetchJob *job);
+void fetch_cancel(FetchJob *job);
+void fetch_abort(FetchJob *job);
+
+#endif
@@ -0,0 +1,56 @@
+#include "frame.h"
+#include "term.h"
+#include <3ds.h>
+#include <stdio.h>
+
+static int idleMs = FRAME_IDLE_DEFAULT;
+static int activeFrames = FRAME_ACTIVE;
+static bool damaged;
+
+// ── Configurazione ────────────────────────────────────────────────────────
+// idle.txt contiene il periodo di riposo in millisecondi
+void frame_init(void) {
+    FILE *f = fopen(FRAME_CFG_FILE, "r");
+    if (!f) return;
+    int ms = 0;
+    if (fscanf(f, "%d", &ms) == 1) frame_set_idle(ms);
+    fclose(f);
+}
+
+void frame_set_idle(int ms) {
+    idleMs = ms < FRAME_IDLE_MIN ? FRAME_IDLE_MIN
+           : ms > FRAME_IDLE_MAX ? FRAME_IDLE_MAX : ms;
+}
+
+// ── Presentazione ─────────────────────────────────────────────────────────
+// La console e' a buffer singolo: basta riportare in memoria le righe di
+// cache scritte da term_flush().
+bool frame_present(void) {
+    bool drawn = term_flush() || damaged;
+    damaged = false;
+    if (!drawn) return false;
+    gfxFlushBuffers();
+    gfxSwapBuffers();
+    activeFrames = FRAME_ACTIVE;
+    return true;
+}
+
+void frame_damage(void) {
+    damaged = true;
+}
+
+void frame_wait(bool busy) {
+    if (hidKeysHeld()) activeFrames = FRAME_ACTIVE;
+
+    if (busy || activeFrames > 0) {
+        if (activeFrames > 0) activeFrames--;
+        gspWaitForVBlank();
+        return;
+    }
+    svcSleepThread((s64)idleMs * 1000000);
+}
+
+void frame_pause(int ms) {
+    frame_present();
+    svcSleepThread((s64)ms * 1000000);
+}
@@ -0,0 +1,29 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdbool.h>
+
+// Ritmo del ciclo principale: si presenta un frame solo se qualche cella
+// e' cambiata, e senza input ne' animazioni il ciclo dorme per il
+// periodo di riposo invece di svegliarsi a ogni VBlank.
+
+#define FRAME_CFG_FILE      "/3ds/3ds-weather/idle.txt"
+#define FRAME_IDLE_DEFAULT  50     // ms
+#define FRAME_IDLE_MIN      16
+#define FRAME_IDLE_MAX      1000
+#define FRAME_ACTIVE        30     // frame a 60 Hz dopo l'ultimo input
+
+void frame_init(void);
+void frame_set_idle(int ms);
+// Disegna le celle cambiate; true se qualcosa e' stato presentato
+bool frame_present(void);
+// Segnala un disegno fatto fuori da term (grafici): il prossimo
+// frame_present() presenta anche senza celle cambiate
+void frame_damage(void);
+// Attesa fino al prossimo giro: un VBlank se busy (animazione in corso)
+// o subito dopo un input, altrimenti il periodo di riposo
+void frame_wait(bool busy);
+// Presenta e attende ms senza leggere l'input
+void frame_pause(int ms);
+
+#endif
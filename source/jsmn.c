@@ -94,7 +94,7 @@ int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
                     break;
                 }
             }
-            for (; i > 0; i--) {
+            for (; i >= 0; i--) {
                 token = &tokens[i];
                 if (token->start != -1 && token->end == -1) {
                     parser->toksuper = i;
@@ -14,7 +14,7 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_REORDER_HINT]   = " SELECT: riordina",
     [STR_POWERED_BY]     = " Dati: Open-Meteo.com",
     [STR_CURRENT_TITLE]  = "METEO ATTUALE",
-    [STR_HOURLY_TITLE]   = "ORA PER ORA - OGGI",
+    [STR_HOURLY_TITLE]   = "ORA PER ORA",
     [STR_DAILY_TITLE]    = "PREVISIONI 7 GIORNI",
     [STR_DETAILS_TITLE]  = "DATI AGGIUNTIVI",
     [STR_LEGEND_TITLE]   = "LEGENDA SIMBOLI",
@@ -65,6 +65,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: indietro",
     [STR_SELECT_LANG]    = " A: seleziona  B: indietro",
     [STR_NOW]            = "ORA",
+    [STR_STALE]          = "vecchi dati",
+    [STR_NO_DATA]        = " Dati non disponibili.",
 },
 
 [LANG_EN] = {
@@ -76,7 +78,7 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_REORDER_HINT]   = " SELECT: reorder",
     [STR_POWERED_BY]     = " Data: Open-Meteo.com",
     [STR_CURRENT_TITLE]  = "CURRENT WEATHER",
-    [STR_HOURLY_TITLE]   = "HOURLY FORECAST - TODAY",
+    [STR_HOURLY_TITLE]   = "HOURLY FORECAST",
     [STR_DAILY_TITLE]    = "7-DAY FORECAST",
     [STR_DETAILS_TITLE]  = "ADDITIONAL DATA",
     [STR_LEGEND_TITLE]   = "SYMBOL LEGEND",
@@ -127,6 +129,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: back",
     [STR_SELECT_LANG]    = " A: select  B: back",
     [STR_NOW]            = "NOW",
+    [STR_STALE]          = "old data",
+    [STR_NO_DATA]        = " Data not available.",
 },
 
 [LANG_FR] = {
@@ -189,6 +193,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: retour",
     [STR_SELECT_LANG]    = " A: selectionner  B: retour",
     [STR_NOW]            = "MAINTENANT",
+    [STR_STALE]          = "donnees anciennes",
+    [STR_NO_DATA]        = " Donnees indisponibles.",
 },
 
 [LANG_ES] = {
@@ -251,6 +257,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: volver",
     [STR_SELECT_LANG]    = " A: seleccionar  B: volver",
     [STR_NOW]            = "AHORA",
+    [STR_STALE]          = "datos antiguos",
+    [STR_NO_DATA]        = " Datos no disponibles.",
 },
 
 [LANG_DE] = {
@@ -313,6 +321,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: zurueck",
     [STR_SELECT_LANG]    = " A: auswaehlen  B: zurueck",
     [STR_NOW]            = "JETZT",
+    [STR_STALE]          = "alte Daten",
+    [STR_NO_DATA]        = " Keine Daten.",
 },
 
 [LANG_UK] = {
@@ -375,6 +385,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: nazad",
     [STR_SELECT_LANG]    = " A: vybraty  B: nazad",
     [STR_NOW]            = "ZARAZ",
+    [STR_STALE]          = "stari dani",
+    [STR_NO_DATA]        = " Dani nedostupni.",
 },
 
 [LANG_JA] = {
@@ -386,7 +398,7 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_REORDER_HINT]   = " SELECT: narabekae",
     [STR_POWERED_BY]     = " Data: Open-Meteo.com",
     [STR_CURRENT_TITLE]  = "GENZAI NO TENKI",
-    [STR_HOURLY_TITLE]   = "JIKAN YOHOU - KYO",
+    [STR_HOURLY_TITLE]   = "JIKAN YOHOU",
     [STR_DAILY_TITLE]    = "7NKAN YOHOU",
     [STR_DETAILS_TITLE]  = "SHOUSAI JOUHOU",
     [STR_LEGEND_TITLE]   = "KIGOU NO SETSUMEI",
@@ -437,6 +449,8 @@ static const char *strings[LANG_COUNT][STR_COUNT] = {
     [STR_NAV_BACK]       = " B: modoru",
     [STR_SELECT_LANG]    = " A: sentaku  B: modoru",
     [STR_NOW]            = "IMA",
+    [STR_STALE]          = "furui deeta",
+    [STR_NO_DATA]        = " Deeta nashi.",
 },
 
 };
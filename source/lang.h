@@ -72,6 +72,8 @@ typedef enum {
     STR_NAV_BACK,
     STR_SELECT_LANG,
     STR_NOW,
+    STR_STALE,
+    STR_NO_DATA,
     STR_COUNT
 } StrKey;
 
@@ -7,25 +7,27 @@
 #include "weather.h"
 #include "cities.h"
 #include "lang.h"
-
-#define C_RST  "\x1b[0m"
-#define C_RED  "\x1b[31m"
-#define C_GRN  "\x1b[32m"
-#define C_YLW  "\x1b[33m"
-#define C_BLU  "\x1b[34m"
-#define C_MAG  "\x1b[35m"
-#define C_CYN  "\x1b[36m"
-#define C_WHT  "\x1b[37m"
-#define C_BLD  "\x1b[1m"
+#include "cache.h"
+#include "prefetch.h"
+#include "fetch.h"
+#include "term.h"
+#include "render.h"
+#include "frame.h"
+#include "ansi.h"
+#include "wxfmt.h"
+#include "vlist.h"
+#include "chart.h"
+#include "prof.h"
 
 #define T(k) lang_get(k)
 
 // ── Forward declarations ──────────────────────────────────────────────────
 static void draw_city_list(const City *c, int n, int sel);
 static void draw_current(const WeatherData *w, const char *city);
-static void draw_hourly(const WeatherData *w, const char *city, int off);
+static void draw_hourly(const WeatherData *w, const char *city);
 static void draw_daily(const WeatherData *w, const char *city);
 static void draw_details(const WeatherData *w, const char *city);
+static void draw_graphs(const WeatherData *w, const char *city, int day);
 static void draw_legend(void);
 static void draw_language(int sel);
 static void draw_reorder(const City *c, int n, int sel, int moving);
@@ -40,19 +42,24 @@ typedef enum {
     SCR_HOURLY,
     SCR_DAILY,
     SCR_DETAILS,
+    SCR_GRAPHS,
     SCR_LEGEND,
     SCR_LANGUAGE,
     SCR_REORDER,
     SCR_COMPARE_SEL,
     SCR_COMPARE,
+    SCR_COMPARE_LOAD,
     SCR_CREDITS,
     SCR_MENU,
+    SCR_LOADING,
 } Screen;
 
 typedef enum {
     MENU_LANGUAGE = 0,
     MENU_LEGEND,
     MENU_COMPARE,
+    MENU_PREFETCH,
+    MENU_PROFILER,
     MENU_CREDITS,
     MENU_COUNT
 } MenuItem;
@@ -61,6 +68,8 @@ static const char *menu_labels[MENU_COUNT] = {
     "Language / Lingua",
     "Symbol legend",
     "Compare cities",
+    "Prefetch cities",
+    "Profiler overlay",
     "Credits",
 };
 
@@ -88,491 +97,723 @@ static void lang_load(void) {
     lang_set((LangID)id);
 }
 
+// ── Prefetch persistence ──────────────────────────────────────────────────
+static bool prefetchOn = false;
+
+static void prefetch_cfg_save(void) {
+    FILE *f = fopen(PREFETCH_FILE, "w");
+    if (!f) return;
+    fprintf(f, "%d\n", prefetchOn ? 1 : 0);
+    fclose(f);
+}
+
+static void prefetch_cfg_load(void) {
+    FILE *f = fopen(PREFETCH_FILE, "r");
+    if (!f) return;
+    int on = 0;
+    fscanf(f, "%d", &on);
+    fclose(f);
+    prefetchOn = (on != 0);
+}
+
+// ── Profiler ──────────────────────────────────────────────────────────────
+// Tabella delle sezioni di prof.h nelle ultime righe dello schermo
+// inferiore, sopra qualsiasi schermata; i numeri si aggiornano una volta
+// al secondo, cosi' l'overlay non tiene sveglio il ciclo a ogni frame.
+#define PROF_ROW        (30 - PROF_COUNT - 1)
+#define PROF_REFRESH_MS 1000
+
+static bool profOverlay = false;
+static char profLines[PROF_COUNT][48];
+static u64  profUpdated;
+// Sui grafici le righe della tabella sono riservate a chart.c e il flush
+// non le scrive: la tabella si ridipinge sopra il grafico quando i
+// numeri cambiano o il grafico e' stato ridisegnato
+static bool profCovered;
+
+// Microsecondi come millisecondi con un decimale, allineati su width
+static void fmt_ms(char *dst, int size, u32 us) {
+    snprintf(dst, size, "%5lu.%lu", (unsigned long)(us / 1000),
+             (unsigned long)(us / 100 % 10));
+}
+
+static void draw_prof_overlay(void) {
+    u64  now   = osGetTime();
+    bool fresh = now - profUpdated >= PROF_REFRESH_MS || profUpdated == 0;
+    if (fresh) {
+        profUpdated = now;
+        for (int s = 0; s < PROF_COUNT; s++) {
+            ProfStats st;
+            char mn[12], av[12], p95[12];
+            prof_stats((ProfSection)s, &st);
+            fmt_ms(mn,  sizeof(mn),  st.min);
+            fmt_ms(av,  sizeof(av),  st.avg);
+            fmt_ms(p95, sizeof(p95), st.p95);
+            snprintf(profLines[s], sizeof(profLines[s]),
+                     "%-7s %4lu%s%s%s ", prof_name((ProfSection)s),
+                     (unsigned long)(st.count % 10000), mn, av, p95);
+        }
+    }
+    term_select(&botScreen);
+    term_goto(0, PROF_ROW);
+    term_printf(C_MAG C_BLD "%-7s %4s%7s%7s%7s " C_RST,
+                "ms", "cnt", "min", "avg", "p95");
+    for (int s = 0; s < PROF_COUNT; s++) {
+        term_goto(0, PROF_ROW + 1 + s);
+        term_printf(C_WHT "%s" C_RST, profLines[s]);
+    }
+    if (term_reserved(0, PROF_ROW) && (fresh || profCovered)) {
+        term_paint(PROF_ROW, PROF_COUNT + 1);
+        frame_damage();
+        profCovered = false;
+    }
+}
+
 // ── Helpers ───────────────────────────────────────────────────────────────
 static const char *wind_dir_str(int deg) {
     const char *d[] = {"N","NE","E","SE","S","SO","O","NO"};
     return d[((deg + 22) % 360) / 45];
 }
 
+// Dati mostrati dalla cache scaduta mentre l'aggiornamento e' in corso
+// (o fallito): il nome della citta' nell'intestazione lo segnala.
+static bool dataStale = false;
+
+static const char *city_sub(const char *city) {
+    static char sub[80];
+    if (!dataStale) return city;
+    snprintf(sub, sizeof(sub), "%s  [%s]", city, T(STR_STALE));
+    return sub;
+}
+
+// Dati gia' disponibili senza rete: prima quelli del prefetch in
+// memoria, poi la cache su SD
+static CacheState lookup_weather(const City *c, WeatherData *out) {
+    if (prefetch_get(c, out) == CACHE_FRESH) return CACHE_FRESH;
+    return cache_load(c, out, NULL);
+}
+
+// ── Blocchi per schermata ─────────────────────────────────────────────────
+// La prima schermata si disegna con la sola corrente (una richiesta
+// piccola); le prossime ore e l'UV della schermata corrente arrivano
+// subito dopo, con oraria e giornaliera. Ogni risposta porta comunque
+// la corrente, quindi un download parte solo se manca o e' scaduto un
+// blocco della schermata aperta, e allora prende anche gli altri
+// blocchi scaduti (cache_due, ognuno con la sua durata). Dopo un errore
+// si riprova tra REFRESH_RETRY secondi o aprendo una schermata che
+// mostra un blocco mancante.
+#define COMPARE_BLOCKS  (WEATHER_CURRENT | WEATHER_DAILY)
+#define REFRESH_RETRY   60
+
+static FetchJob job;            // blocchi della citta' aperta
+static time_t   retryAt;        // prossimo aggiornamento dopo un errore
+
+static unsigned screen_blocks(Screen s) {
+    switch (s) {
+    case SCR_CURRENT: return WEATHER_ALL;
+    case SCR_HOURLY:  return WEATHER_HOURLY;
+    case SCR_DAILY:   return WEATHER_DAILY;
+    case SCR_DETAILS: return WEATHER_CURRENT | WEATHER_DAILY;
+    case SCR_GRAPHS:  return WEATHER_HOURLY | WEATHER_DAILY;
+    default:          return 0;
+    }
+}
+
+// Al posto dei dati che mancano ancora: "scaricando" se un download e'
+// in corso o parte al prossimo giro, altrimenti (attesa dopo un errore)
+// "non disponibili". La schermata si ridisegna quando il download parte
+// e quando finisce.
+static bool missing_blocks(const WeatherData *w, unsigned blocks) {
+    if ((w->blocks & blocks) == blocks) return false;
+    bool busy = job.state != JOB_IDLE
+             || (w->valid && time(NULL) >= retryAt);
+    term_printf(C_YLW "\n%s\n" C_RST,
+                T(busy ? STR_DOWNLOADING : STR_NO_DATA));
+    return true;
+}
+
 // ── Draw helpers ──────────────────────────────────────────────────────────
 static void draw_header_top(const char *title, const char *sub) {
-    consoleSelect(&topScreen);
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_YLW C_BLD " %s\n" C_RST, title);
+    term_select(&topScreen);
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_YLW C_BLD " %s\n" C_RST, title);
     if (sub && sub[0])
-        printf(C_WHT " %s\n" C_RST, sub);
-    printf(C_CYN "================================\n" C_RST);
+        term_printf(C_WHT " %s\n" C_RST, sub);
+    term_printf(C_CYN "================================\n" C_RST);
 }
 
 static void draw_header_bot(const char *title) {
-    consoleSelect(&botScreen);
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_MAG C_BLD " %s\n" C_RST, title);
-    printf(C_CYN "================================\n" C_RST);
+    term_select(&botScreen);
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_MAG C_BLD " %s\n" C_RST, title);
+    term_printf(C_CYN "================================\n" C_RST);
 }
 
 // ── Menu SELECT ───────────────────────────────────────────────────────────
 static void draw_menu(int sel) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top("MENU", NULL);
-    printf("\n");
+    term_printf("\n");
     for (int i = 0; i < MENU_COUNT; i++) {
+        bool on = (i == MENU_PREFETCH) ? prefetchOn : profOverlay;
+        const char *state = (i != MENU_PREFETCH && i != MENU_PROFILER) ? ""
+                          : on ? " [ON]" : " [OFF]";
         if (i == sel)
-            printf(C_GRN C_BLD " > %s\n" C_RST, menu_labels[i]);
+            term_printf(C_GRN C_BLD " > %s%s\n" C_RST, menu_labels[i], state);
         else
-            printf(C_WHT "   %s\n" C_RST, menu_labels[i]);
+            term_printf(C_WHT "   %s%s\n" C_RST, menu_labels[i], state);
     }
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT " UP/DOWN: navigate\n" C_RST);
-    printf(C_WHT " A: enter  B/SELECT: close\n" C_RST);
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " UP/DOWN: navigate\n" C_RST);
+    term_printf(C_WHT " A: enter  B/SELECT: close\n" C_RST);
 
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("3DS WEATHER");
-    printf(C_WHT "\n By: " C_GRN C_BLD "Dzhmelyk135\n\n" C_RST);
-    printf(C_WHT " github.com/\n" C_RST);
-    printf(C_CYN "   Dzhmelyk135/\n" C_RST);
-    printf(C_CYN "   Luma3DSWeather\n\n" C_RST);
-    printf(C_WHT " Data: " C_CYN "Open-Meteo.com\n" C_RST);
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT " SELECT: open/close menu\n" C_RST);
+    term_printf(C_WHT "\n By: " C_GRN C_BLD "Dzhmelyk135\n\n" C_RST);
+    term_printf(C_WHT " github.com/\n" C_RST);
+    term_printf(C_CYN "   Dzhmelyk135/\n" C_RST);
+    term_printf(C_CYN "   Luma3DSWeather\n\n" C_RST);
+    term_printf(C_WHT " Data: " C_CYN "Open-Meteo.com\n" C_RST);
+    NetStats ns;
+    weather_net_stats(&ns);
+    term_printf(C_WHT " HTTP: " C_CYN "%u req, %u keep-alive eligible\n" C_RST,
+           ns.requests, ns.keepalive);
+    // Media fino alle intestazioni: se il sysmodule riusa davvero la
+    // connessione, la seconda e' molto piu' bassa
+    term_printf(C_WHT " Wait: " C_CYN "%u ms new, %u ms keep-alive\n" C_RST,
+           ns.connects  ? ns.connect_ms   / ns.connects  : 0,
+           ns.keepalive ? ns.keepalive_ms / ns.keepalive : 0);
+    MemStats ms;
+    weather_mem_stats(&ms);
+    term_printf(C_WHT " Mem:  " C_CYN "%u/%u KB peak, %u failed\n" C_RST,
+           (ms.peak + 1023) / 1024, ms.size / 1024, ms.fails);
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " SELECT: open/close menu\n" C_RST);
+}
+
+// ── Liste ─────────────────────────────────────────────────────────────────
+// Finestre visibili delle liste: le schermate con l'elenco citta' non
+// sono mai aperte insieme e condividono la stessa
+#define LIST_ROWS   14
+#define HOUR_ROWS   20   // schermo superiore
+#define HOUR_ROWS2  24   // seguito sullo schermo inferiore
+
+static VList cityView;
+static VList hourView;
+
+typedef struct {
+    const City *c;
+    int  sel1, sel2;     // confronto: citta' gia' scelta e cursore
+    int  step;
+    bool moving;         // riordina: citta' in spostamento
+} CityRows;
+
+static void city_row(void *user, int i, bool sel) {
+    const City *c = ((const CityRows*)user)->c;
+    if (sel)
+        term_printf(C_GRN C_BLD " > %s" C_RST, c[i].name);
+    else
+        term_printf(C_WHT "   %s" C_RST, c[i].name);
+}
+
+static void reorder_row(void *user, int i, bool sel) {
+    const CityRows *r = user;
+    if (sel && r->moving)
+        term_printf(C_YLW C_BLD " >> %s" C_RST, r->c[i].name);
+    else if (sel)
+        term_printf(C_GRN C_BLD " >  %s" C_RST, r->c[i].name);
+    else
+        term_printf(C_WHT "    %s" C_RST, r->c[i].name);
+}
+
+static void compare_row(void *user, int i, bool sel) {
+    const CityRows *r = user;
+    if (sel)
+        term_printf(C_GRN C_BLD " > %s" C_RST, r->c[i].name);
+    else if (r->step == 2 && i == r->sel1)
+        term_printf(C_CYN "   %s [1]" C_RST, r->c[i].name);
+    else
+        term_printf(C_WHT "   %s" C_RST, r->c[i].name);
+}
+
+static void hour_row(void *user, int i, bool sel) {
+    (void)sel;
+    term_printf("%s", ((const WxLines*)user)->hourly[i]);
+}
+
+static void draw_cities(const City *c, int n, int sel, VListRow row,
+                        CityRows *r) {
+    r->c = c;
+    vlist_set_count(&cityView, n);
+    vlist_show(&cityView, sel);
+    vlist_draw(&cityView, sel, row, r);
 }
 
 // ── Schermata lista citta' ────────────────────────────────────────────────
 static void draw_city_list(const City *c, int n, int sel) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top(T(STR_APP_TITLE), T(STR_CITY_LIST_TITLE));
-    printf(C_WHT " %s\n %s\n" C_RST,
+    term_printf(C_WHT " %s\n %s\n" C_RST,
            T(STR_NAV_HINT), T(STR_ADD_HINT));
-    printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
     if (n == 0) {
-        printf(C_RED " %s\n %s\n" C_RST,
+        term_printf(C_RED " %s\n %s\n" C_RST,
                T(STR_NO_CITIES), T(STR_FIRST_CITY));
     } else {
-        for (int i = 0; i < n; i++) {
-            if (i == sel)
-                printf(C_GRN C_BLD " > %s\n" C_RST, c[i].name);
-            else
-                printf(C_WHT "   %s\n" C_RST, c[i].name);
-        }
+        CityRows r = { 0 };
+        draw_cities(c, n, sel, city_row, &r);
     }
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " A:meteo  X:add  Y:del  START:exit\n" C_RST);
-    printf(C_WHT " L:reorder  R:compare  SEL:menu\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " A:meteo  X:add  Y:del  START:exit\n" C_RST);
+    term_printf(C_WHT " L:reorder  R:compare  SEL:menu\n" C_RST);
 
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("3DS WEATHER  by Dzhmelyk135");
-    printf(C_CYN "\n github.com/Dzhmelyk135/\n" C_RST);
-    printf(C_CYN " Luma3DSWeather\n\n" C_RST);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " A:      " C_CYN "fetch weather\n" C_RST);
-    printf(C_WHT " X:      " C_CYN "add city\n" C_RST);
-    printf(C_WHT " Y:      " C_CYN "delete city\n" C_RST);
-    printf(C_WHT " L:      " C_CYN "reorder cities\n" C_RST);
-    printf(C_WHT " R:      " C_CYN "compare cities\n" C_RST);
-    printf(C_WHT " SELECT: " C_CYN "menu\n" C_RST);
-    printf(C_WHT " START:  " C_CYN "exit\n" C_RST);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_YLW " %s\n" C_RST, T(STR_POWERED_BY));
+    term_printf(C_CYN "\n github.com/Dzhmelyk135/\n" C_RST);
+    term_printf(C_CYN " Luma3DSWeather\n\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " A:      " C_CYN "fetch weather\n" C_RST);
+    term_printf(C_WHT " X:      " C_CYN "add city\n" C_RST);
+    term_printf(C_WHT " Y:      " C_CYN "delete city\n" C_RST);
+    term_printf(C_WHT " L:      " C_CYN "reorder cities\n" C_RST);
+    term_printf(C_WHT " R:      " C_CYN "compare cities\n" C_RST);
+    term_printf(C_WHT " SELECT: " C_CYN "menu\n" C_RST);
+    term_printf(C_WHT " START:  " C_CYN "exit\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_YLW " %s\n" C_RST, T(STR_POWERED_BY));
 }
 
 // ── Schermata meteo attuale ───────────────────────────────────────────────
 static void draw_current(const WeatherData *w, const char *city) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    draw_header_top(T(STR_CURRENT_TITLE), city);
-    printf(C_YLW "\n %s  %s\n\n" C_RST,
+    term_select(&topScreen);
+    term_clear();
+    const WxLines *l = wxfmt_lines(w, city);
+    draw_header_top(T(STR_CURRENT_TITLE), city_sub(city));
+    term_printf(C_YLW "\n %s  %s\n\n" C_RST,
            weather_code_icon(w->weather_code_now),
            weather_code_desc(w->weather_code_now));
-    printf(C_WHT "%s" C_YLW "%.1fC\n" C_RST,
-           T(STR_TEMP), w->temp_now);
-    printf(C_WHT "%s" C_YLW "%.1fC\n" C_RST,
-           T(STR_FEELS), w->feels_like_now);
-    printf(C_WHT "%s" C_CYN "%.0f%%\n" C_RST,
-           T(STR_HUMIDITY), w->humidity_now);
-    printf(C_WHT "%s" C_GRN "%.0f hPa\n" C_RST,
-           T(STR_PRESSURE), w->pressure_now);
-    printf(C_WHT "%s" C_MAG "%.1f km/h %s\n" C_RST,
-           T(STR_WIND), w->wind_now,
-           wind_dir_str(w->wind_dir_now));
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " L:hourly  R:7days  X:details  B:back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST, T(STR_TEMP), l->temp);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST, T(STR_FEELS), l->feels);
+    term_printf(C_WHT "%s" C_CYN "%s\n" C_RST,
+           T(STR_HUMIDITY), l->humidity);
+    term_printf(C_WHT "%s" C_GRN "%s hPa\n" C_RST,
+           T(STR_PRESSURE), l->pressure);
+    term_printf(C_WHT "%s" C_MAG "%s km/h %s\n" C_RST,
+           T(STR_WIND), l->wind, wind_dir_str(w->wind_dir_now));
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " L:hourly  R:7days  X:details  Y:graphs\n" C_RST);
+    term_printf(C_WHT " B:back\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("DETAILS + NEXT HOURS");
-    printf(C_WHT "%s" C_YLW "%02d:%02d\n" C_RST,
-           T(STR_SUNRISE), w->sunrise_hour, w->sunrise_min);
-    printf(C_WHT "%s" C_YLW "%02d:%02d\n" C_RST,
-           T(STR_SUNSET),  w->sunset_hour,  w->sunset_min);
-    printf(C_WHT "%s" C_RED "%.1f\n" C_RST,
-           T(STR_UV), w->uv_index);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_CYN " Hour Temp  Rain Weather\n" C_RST);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST, T(STR_SUNRISE), l->sunrise);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST, T(STR_SUNSET),  l->sunset);
+    term_printf(C_WHT "%s" C_RED "%s\n" C_RST, T(STR_UV),      l->uv);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_CYN " Hour Temp  Rain Weather\n" C_RST);
+    if (missing_blocks(w, WEATHER_HOURLY)) return;
     int cur = w->current_hour;
     int shown = 0;
-    for (int i = cur; i < HOURLY_COUNT && shown < 7; i++, shown++) {
-        printf(i == cur ? C_YLW C_BLD : C_WHT);
-        printf(" %02d:00 %4.1fC %3.1fmm %s\n" C_RST,
-               i, w->hourly_temp[i],
-               w->hourly_precip[i],
-               weather_code_icon(w->hourly_code[i]));
-    }
+    for (int i = cur; i < w->hourly_count && shown < 7; i++, shown++)
+        term_printf("%s%s\n" C_RST, i == cur ? C_YLW C_BLD : C_WHT,
+                    l->hour_short[i]);
 }
 
 // ── Schermata oraria ──────────────────────────────────────────────────────
-static void draw_hourly(const WeatherData *w,
-                         const char *city, int off) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    draw_header_top(T(STR_HOURLY_TITLE), city);
-    printf(C_CYN " Hour Temp   Rain  Hum  Weather\n" C_RST);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    int shown = 0;
-    for (int i = off; i < HOURLY_COUNT && shown < 12; i++, shown++) {
-        if (i == w->current_hour)
-            printf(C_YLW C_BLD " %02d:00 %4.1fC %3.1fmm %3.0f%% %s<\n" C_RST,
-                   i, w->hourly_temp[i], w->hourly_precip[i],
-                   w->hourly_humidity[i],
-                   weather_code_icon(w->hourly_code[i]));
-        else
-            printf(C_WHT " %02d:00" C_YLW " %4.1fC"
-                   C_CYN " %3.1fmm" C_BLU " %3.0f%%"
-                   C_GRN " %s\n" C_RST,
-                   i, w->hourly_temp[i], w->hourly_precip[i],
-                   w->hourly_humidity[i],
-                   weather_code_icon(w->hourly_code[i]));
-    }
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " UP/DOWN: scroll  B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+// La finestra superiore e' hourView; l'inferiore mostra le ore seguenti
+static void draw_hourly(const WeatherData *w, const char *city) {
+    const WxLines *l = wxfmt_lines(w, city);
+    vlist_set_count(&hourView, w->hourly_count);
+
+    term_select(&topScreen);
+    term_clear();
+    draw_header_top(T(STR_HOURLY_TITLE), city_sub(city));
+    term_printf(C_CYN " Day Hour Temp   Rain  Hum  Weather\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    if (!missing_blocks(w, WEATHER_HOURLY))
+        vlist_draw(&hourView, -1, hour_row, (void*)l);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " UP/DOWN: scroll  LEFT/RIGHT: day  B: back\n" C_RST);
+
+    VList next;
+    vlist_init(&next, HOUR_ROWS2, 1);
+    next.count = w->hourly_count;
+    next.top   = hourView.top + hourView.rows;
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("NEXT HOURS");
-    printf(C_CYN " Hour Temp   Rain  Hum  Weather\n" C_RST);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    int start2 = off + 12;
-    for (int i = start2; i < HOURLY_COUNT; i++) {
-        if (i == w->current_hour)
-            printf(C_YLW C_BLD " %02d:00 %4.1fC %3.1fmm %3.0f%% %s<\n" C_RST,
-                   i, w->hourly_temp[i], w->hourly_precip[i],
-                   w->hourly_humidity[i],
-                   weather_code_icon(w->hourly_code[i]));
-        else
-            printf(C_WHT " %02d:00" C_YLW " %4.1fC"
-                   C_CYN " %3.1fmm" C_BLU " %3.0f%%"
-                   C_GRN " %s\n" C_RST,
-                   i, w->hourly_temp[i], w->hourly_precip[i],
-                   w->hourly_humidity[i],
-                   weather_code_icon(w->hourly_code[i]));
-    }
+    term_printf(C_CYN " Day Hour Temp   Rain  Hum  Weather\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    if (next.top < next.count)
+        vlist_draw(&next, -1, hour_row, (void*)l);
 }
 
 // ── Schermata giornaliera ─────────────────────────────────────────────────
 static void draw_daily(const WeatherData *w, const char *city) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    draw_header_top(T(STR_DAILY_TITLE), city);
-    printf(C_CYN " Date      Max  Min  Rain Wind\n" C_RST);
-    printf(C_CYN "----------------------------------\n" C_RST);
-    for (int i = 0; i < 4 && i < FORECAST_DAYS; i++) {
-        printf(i==0 ? C_YLW C_BLD : C_WHT);
-        printf(" %s %3.0fC %3.0fC %3.1fmm %3.0fkm %s\n" C_RST,
-               w->daily_date[i],
-               w->daily_max[i], w->daily_min[i],
-               w->daily_precip[i], w->daily_wind_max[i],
-               weather_code_icon(w->daily_code[i]));
-    }
-    printf(C_CYN "----------------------------------\n" C_RST);
-    printf(C_WHT " B:back  L:hourly  X:details\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+    const WxLines *l = wxfmt_lines(w, city);
+    term_select(&topScreen);
+    term_clear();
+    draw_header_top(T(STR_DAILY_TITLE), city_sub(city));
+    term_printf(C_CYN " Date      Max  Min  Rain Wind\n" C_RST);
+    term_printf(C_CYN "----------------------------------\n" C_RST);
+    bool ready = !missing_blocks(w, WEATHER_DAILY);
+    for (int i = 0; ready && i < 4 && i < FORECAST_DAYS; i++)
+        term_printf("%s%s\n" C_RST, i == 0 ? C_YLW C_BLD : C_WHT,
+                    l->daily[i]);
+    term_printf(C_CYN "----------------------------------\n" C_RST);
+    term_printf(C_WHT " B:back  L:hourly  X:details\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("NEXT DAYS");
-    printf(C_CYN " Date      Max  Min  Rain Wind\n" C_RST);
-    printf(C_CYN "----------------------------------\n" C_RST);
-    for (int i = 4; i < FORECAST_DAYS; i++) {
-        printf(C_WHT " %s %3.0fC %3.0fC %3.1fmm %3.0fkm %s\n" C_RST,
-               w->daily_date[i],
-               w->daily_max[i], w->daily_min[i],
-               w->daily_precip[i], w->daily_wind_max[i],
-               weather_code_icon(w->daily_code[i]));
+    term_printf(C_CYN " Date      Max  Min  Rain Wind\n" C_RST);
+    term_printf(C_CYN "----------------------------------\n" C_RST);
+    for (int i = 4; ready && i < FORECAST_DAYS; i++)
+        term_printf(C_WHT "%s\n" C_RST, l->daily[i]);
+}
+
+// ── Schermata grafici ─────────────────────────────────────────────────────
+// Lo schermo inferiore sotto l'intestazione e' di chart.c: ore del giorno
+// day (righe 4-17) e minime/massime dei 7 giorni (righe 18-29)
+#define GRAPH_ROW    4
+#define GRAPH_ROWS1  14
+#define GRAPH_ROWS2  12
+
+static void draw_graphs(const WeatherData *w, const char *city, int day) {
+    Chart hourly, daily;
+    if ((w->blocks & screen_blocks(SCR_GRAPHS)) != screen_blocks(SCR_GRAPHS)) {
+        term_select(&botScreen);
+        term_clear();
+        draw_header_bot("HOURLY + 7 DAYS");
+        term_select(&topScreen);
+        term_clear();
+        draw_header_top("GRAPHS", city_sub(city));
+        missing_blocks(w, WEATHER_HOURLY | WEATHER_DAILY);
+        return;
     }
+    term_select(&botScreen);
+    term_clear();
+    chart_target((u16*)gfxGetFramebuffer(GFX_BOTTOM, GFX_LEFT, NULL, NULL),
+                 term_width());
+    chart_hourly(&hourly, w, day * 24, 24, GRAPH_ROW, GRAPH_ROWS1);
+    chart_daily(&daily, w, GRAPH_ROW + GRAPH_ROWS1, GRAPH_ROWS2);
+
+    term_select(&topScreen);
+    term_clear();
+    draw_header_top("GRAPHS", city_sub(city));
+    term_printf(C_WHT "\n Day: " C_YLW C_BLD "%s\n\n" C_RST,
+           w->daily_date[day]);
+    term_printf(C_YLW " ---" C_WHT " temperature (C)\n" C_RST);
+    term_printf(C_BLU " ###" C_WHT " rain, full scale %s\n\n" C_RST,
+           hourly.rain);
+    term_printf(C_WHT " 7 days:\n" C_RST);
+    term_printf(C_RED " ---" C_WHT " max  " C_CYN "---" C_WHT " min\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " LEFT/RIGHT: day  B: back\n" C_RST);
+
+    term_select(&botScreen);
+    draw_header_bot("HOURLY + 7 DAYS");
+    term_reserve(0, GRAPH_ROW, term_width(), GRAPH_ROWS1 + GRAPH_ROWS2);
+    chart_draw(&hourly);
+    chart_draw(&daily);
+    profCovered = true;
+    frame_damage();
 }
 
 // ── Schermata dettagli ────────────────────────────────────────────────────
 static void draw_details(const WeatherData *w, const char *city) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    draw_header_top(T(STR_DETAILS_TITLE), city);
-    printf("\n");
-    printf(C_WHT "%s" C_GRN "%.1f hPa\n" C_RST,
-           T(STR_PRESSURE),  w->pressure_now);
-    printf(C_WHT "%s" C_MAG "%.1f km/h\n" C_RST,
-           T(STR_WIND),      w->wind_now);
-    printf(C_WHT "%s" C_MAG "%d deg (%s)\n" C_RST,
+    const WxLines *l = wxfmt_lines(w, city);
+    term_select(&topScreen);
+    term_clear();
+    draw_header_top(T(STR_DETAILS_TITLE), city_sub(city));
+    term_printf("\n");
+    term_printf(C_WHT "%s" C_GRN "%s hPa\n" C_RST,
+           T(STR_PRESSURE),  l->pressure1);
+    term_printf(C_WHT "%s" C_MAG "%s km/h\n" C_RST,
+           T(STR_WIND),      l->wind);
+    term_printf(C_WHT "%s" C_MAG "%d deg (%s)\n" C_RST,
            T(STR_WIND_DIR),  w->wind_dir_now,
            wind_dir_str(w->wind_dir_now));
-    printf(C_WHT "%s" C_CYN "%.0f%%\n" C_RST,
-           T(STR_HUMIDITY),  w->humidity_now);
-    printf(C_WHT "%s" C_YLW "%.1fC\n" C_RST,
-           T(STR_FEELS_LIKE),w->feels_like_now);
-    printf(C_WHT "%s" C_RED "%.1f\n"  C_RST,
-           T(STR_UV),        w->uv_index);
-    printf(C_WHT "%s" C_YLW "%02d:%02d\n" C_RST,
-           T(STR_DAWN),  w->sunrise_hour, w->sunrise_min);
-    printf(C_WHT "%s" C_YLW "%02d:%02d\n" C_RST,
-           T(STR_DUSK),  w->sunset_hour,  w->sunset_min);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_printf(C_WHT "%s" C_CYN "%s\n" C_RST,
+           T(STR_HUMIDITY),  l->humidity);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST,
+           T(STR_FEELS_LIKE),l->feels);
+    term_printf(C_WHT "%s" C_RED "%s\n"  C_RST,
+           T(STR_UV),        l->uv);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST,
+           T(STR_DAWN),  l->sunrise);
+    term_printf(C_WHT "%s" C_YLW "%s\n" C_RST,
+           T(STR_DUSK),  l->sunset);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " Day    Rise   Set    Light\n" C_RST);
+    for (int i = 0; i < FORECAST_DAYS; i++)
+        term_printf(C_YLW "%s\n" C_RST, l->sun[i]);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " B: back\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("CHARTS");
 
     int bars = (int)((w->pressure_now - 970.f) / 60.f * 28.f);
     bars = bars < 0 ? 0 : bars > 28 ? 28 : bars;
-    printf(C_GRN " Pressure:\n [");
-    for (int i=0;i<28;i++)
-        printf(i<bars ? C_GRN "#" C_RST : C_WHT "-" C_RST);
-    printf(C_CYN "] %.0fhPa\n\n" C_RST, w->pressure_now);
+    term_printf(C_GRN " Pressure:\n [");
+    term_bar(28, bars, RC_GREEN);
+    term_printf(C_CYN "] %shPa\n\n" C_RST, l->pressure);
 
     int wb = (int)(w->wind_now / 120.f * 28.f);
     wb = wb > 28 ? 28 : wb;
-    printf(C_MAG " Wind:\n [");
-    for (int i=0;i<28;i++)
-        printf(i<wb ? C_MAG "#" C_RST : C_WHT "-" C_RST);
-    printf(C_MAG "] %.1fkm/h\n\n" C_RST, w->wind_now);
+    term_printf(C_MAG " Wind:\n [");
+    term_bar(28, wb, RC_MAGENTA);
+    term_printf(C_MAG "] %skm/h\n\n" C_RST, l->wind);
 
     int ub = (int)(w->uv_index / 11.f * 28.f);
     ub = ub > 28 ? 28 : ub;
-    printf(C_RED " UV:\n [");
-    for (int i=0;i<28;i++)
-        printf(i<ub ? C_RED "#" C_RST : C_WHT "-" C_RST);
-    printf(C_RED "] %.1f\n\n" C_RST, w->uv_index);
+    term_printf(C_RED " UV:\n [");
+    term_bar(28, ub, RC_RED);
+    term_printf(C_RED "] %s\n\n" C_RST, l->uv);
 
     int hb = (int)(w->humidity_now / 100.f * 28.f);
     hb = hb > 28 ? 28 : hb;
-    printf(C_CYN " Humidity:\n [");
-    for (int i=0;i<28;i++)
-        printf(i<hb ? C_CYN "#" C_RST : C_WHT "-" C_RST);
-    printf(C_CYN "] %.0f%%\n" C_RST, w->humidity_now);
+    term_printf(C_CYN " Humidity:\n [");
+    term_bar(28, hb, RC_CYAN);
+    term_printf(C_CYN "] %s\n" C_RST, l->humidity);
 }
 
 // ── Schermata legenda ─────────────────────────────────────────────────────
 static void draw_legend(void) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top(T(STR_LEGEND_TITLE), NULL);
-    printf("\n");
-    printf(C_YLW " %s\n" C_RST, T(STR_LEG_SUNNY));
-    printf(C_YLW " %s\n" C_RST, T(STR_LEG_PCLOUDY));
-    printf(C_WHT " %s\n" C_RST, T(STR_LEG_CLOUDY));
-    printf(C_WHT " %s\n" C_RST, T(STR_LEG_FOG));
-    printf(C_CYN " %s\n" C_RST, T(STR_LEG_DRIZZLE));
-    printf(C_BLU " %s\n" C_RST, T(STR_LEG_RAIN));
-    printf(C_WHT " %s\n" C_RST, T(STR_LEG_SNOW));
-    printf(C_RED " %s\n" C_RST, T(STR_LEG_STORM));
-    printf(C_WHT " %s\n" C_RST, T(STR_LEG_UNKNOWN));
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT " B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_printf("\n");
+    term_printf(C_YLW " %s\n" C_RST, T(STR_LEG_SUNNY));
+    term_printf(C_YLW " %s\n" C_RST, T(STR_LEG_PCLOUDY));
+    term_printf(C_WHT " %s\n" C_RST, T(STR_LEG_CLOUDY));
+    term_printf(C_WHT " %s\n" C_RST, T(STR_LEG_FOG));
+    term_printf(C_CYN " %s\n" C_RST, T(STR_LEG_DRIZZLE));
+    term_printf(C_BLU " %s\n" C_RST, T(STR_LEG_RAIN));
+    term_printf(C_WHT " %s\n" C_RST, T(STR_LEG_SNOW));
+    term_printf(C_RED " %s\n" C_RST, T(STR_LEG_STORM));
+    term_printf(C_WHT " %s\n" C_RST, T(STR_LEG_UNKNOWN));
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " B: back\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("WMO CODES");
-    printf(C_WHT " 0      " C_YLW "Clear sky\n" C_RST);
-    printf(C_WHT " 1-2    " C_YLW "Partly cloudy\n" C_RST);
-    printf(C_WHT " 3      " C_WHT "Overcast\n" C_RST);
-    printf(C_WHT " 45,48  " C_WHT "Fog\n" C_RST);
-    printf(C_WHT " 51-55  " C_CYN "Drizzle\n" C_RST);
-    printf(C_WHT " 61-65  " C_BLU "Rain\n" C_RST);
-    printf(C_WHT " 71-77  " C_WHT "Snow\n" C_RST);
-    printf(C_WHT " 80-82  " C_BLU "Showers\n" C_RST);
-    printf(C_WHT " 85-86  " C_WHT "Snow showers\n" C_RST);
-    printf(C_WHT " 95     " C_RED "Thunderstorm\n" C_RST);
-    printf(C_WHT " 96,99  " C_RED "Storm+hail\n" C_RST);
+    term_printf(C_WHT " 0      " C_YLW "Clear sky\n" C_RST);
+    term_printf(C_WHT " 1-2    " C_YLW "Partly cloudy\n" C_RST);
+    term_printf(C_WHT " 3      " C_WHT "Overcast\n" C_RST);
+    term_printf(C_WHT " 45,48  " C_WHT "Fog\n" C_RST);
+    term_printf(C_WHT " 51-55  " C_CYN "Drizzle\n" C_RST);
+    term_printf(C_WHT " 61-65  " C_BLU "Rain\n" C_RST);
+    term_printf(C_WHT " 71-77  " C_WHT "Snow\n" C_RST);
+    term_printf(C_WHT " 80-82  " C_BLU "Showers\n" C_RST);
+    term_printf(C_WHT " 85-86  " C_WHT "Snow showers\n" C_RST);
+    term_printf(C_WHT " 95     " C_RED "Thunderstorm\n" C_RST);
+    term_printf(C_WHT " 96,99  " C_RED "Storm+hail\n" C_RST);
 }
 
 // ── Schermata lingua ──────────────────────────────────────────────────────
 static void draw_language(int sel) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top(T(STR_LANG_TITLE), NULL);
-    printf("\n");
+    term_printf("\n");
     for (int i = 0; i < LANG_COUNT; i++) {
         if (i == sel)
-            printf(C_GRN C_BLD " > %s%s\n" C_RST,
+            term_printf(C_GRN C_BLD " > %s%s\n" C_RST,
                    lang_name(i),
                    (i == (int)currentLang) ? " (*)" : "");
         else
-            printf(C_WHT "   %s%s\n" C_RST,
+            term_printf(C_WHT "   %s%s\n" C_RST,
                    lang_name(i),
                    (i == (int)currentLang) ? " (*)" : "");
     }
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT "%s\n" C_RST, T(STR_SELECT_LANG));
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT "%s\n" C_RST, T(STR_SELECT_LANG));
 
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("LANGUAGE / LINGUA");
-    printf(C_WHT "\n UP/DOWN: navigate\n" C_RST);
-    printf(C_WHT " A:       select\n" C_RST);
-    printf(C_WHT " B:       back\n" C_RST);
-    printf(C_CYN "\n (*) = current language\n" C_RST);
+    term_printf(C_WHT "\n UP/DOWN: navigate\n" C_RST);
+    term_printf(C_WHT " A:       select\n" C_RST);
+    term_printf(C_WHT " B:       back\n" C_RST);
+    term_printf(C_CYN "\n (*) = current language\n" C_RST);
 }
 
 // ── Schermata riordina ────────────────────────────────────────────────────
 static void draw_reorder(const City *c, int n, int sel, int moving) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top(T(STR_REORDER_TITLE), NULL);
-    printf(C_WHT "%s\n" C_RST, T(STR_MOVE_HINT));
-    printf(C_CYN "--------------------------------\n" C_RST);
-    for (int i = 0; i < n; i++) {
-        if (i == sel && moving)
-            printf(C_YLW C_BLD " >> %s\n" C_RST, c[i].name);
-        else if (i == sel)
-            printf(C_GRN C_BLD " >  %s\n" C_RST, c[i].name);
-        else
-            printf(C_WHT "    %s\n" C_RST, c[i].name);
-    }
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " A: %s  B: save & exit\n" C_RST,
+    term_printf(C_WHT "%s\n" C_RST, T(STR_MOVE_HINT));
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    CityRows r = { .moving = moving };
+    draw_cities(c, n, sel, reorder_row, &r);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " A: %s  B: save & exit\n" C_RST,
            moving ? "confirm pos." : "start move");
 
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("REORDER CITIES");
-    printf(C_WHT "\n A:       start / confirm move\n" C_RST);
-    printf(C_WHT " UP/DOWN: move city\n" C_RST);
-    printf(C_WHT " B:       save and exit\n" C_RST);
+    term_printf(C_WHT "\n A:       start / confirm move\n" C_RST);
+    term_printf(C_WHT " UP/DOWN: move city\n" C_RST);
+    term_printf(C_WHT " B:       save and exit\n" C_RST);
 }
 
 // ── Schermata selezione confronto ─────────────────────────────────────────
 static void draw_compare_sel(const City *c, int n,
                               int sel1, int sel2, int step) {
-    consoleSelect(&topScreen);
-    consoleClear();
+    term_select(&topScreen);
+    term_clear();
     draw_header_top("COMPARE CITIES", NULL);
-    printf(C_WHT "\n Step %d/2: select city %d\n\n" C_RST, step, step);
-    for (int i = 0; i < n; i++) {
-        bool is_cursor = (step == 1) ? (i == sel1) : (i == sel2);
-        bool is_locked = (step == 2 && i == sel1);
-        if (is_cursor)
-            printf(C_GRN C_BLD " > %s\n" C_RST, c[i].name);
-        else if (is_locked)
-            printf(C_CYN "   %s [1]\n" C_RST, c[i].name);
-        else
-            printf(C_WHT "   %s\n" C_RST, c[i].name);
-    }
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT " A: confirm  B: cancel\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
+    term_printf(C_WHT "\n Step %d/2: select city %d\n\n" C_RST, step, step);
+    CityRows r = { .sel1 = sel1, .sel2 = sel2, .step = step };
+    draw_cities(c, n, step == 1 ? sel1 : sel2, compare_row, &r);
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " A: confirm  B: cancel\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
     draw_header_bot("COMPARE");
-    printf(C_WHT "\n Select two cities\n" C_RST);
-    printf(C_WHT " to compare.\n\n" C_RST);
+    term_printf(C_WHT "\n Select two cities\n" C_RST);
+    term_printf(C_WHT " to compare.\n\n" C_RST);
     if (step == 2)
-        printf(C_CYN " City 1: %s\n\n" C_RST, c[sel1].name);
-    printf(C_WHT " UP/DOWN: navigate\n" C_RST);
-    printf(C_WHT " A:       select\n" C_RST);
-    printf(C_WHT " B:       cancel\n" C_RST);
+        term_printf(C_CYN " City 1: %s\n\n" C_RST, c[sel1].name);
+    term_printf(C_WHT " UP/DOWN: navigate\n" C_RST);
+    term_printf(C_WHT " A:       select\n" C_RST);
+    term_printf(C_WHT " B:       cancel\n" C_RST);
 }
 
 // ── Schermata confronto ───────────────────────────────────────────────────
 static void draw_compare(const WeatherData *w1, const WeatherData *w2,
                           const char *c1, const char *c2) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_GRN C_BLD " [1] %s\n" C_RST, c1);
-    printf(C_CYN "================================\n" C_RST);
-    printf(C_YLW "\n %s %s\n\n" C_RST,
+    const WxLines *l1 = wxfmt_lines(w1, c1);
+    const WxLines *l2 = wxfmt_lines(w2, c2);
+    term_select(&topScreen);
+    term_clear();
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_GRN C_BLD " [1] %s\n" C_RST, c1);
+    term_printf(C_CYN "================================\n" C_RST);
+    term_printf(C_YLW "\n %s %s\n\n" C_RST,
            weather_code_icon(w1->weather_code_now),
            weather_code_desc(w1->weather_code_now));
-    printf(C_WHT " Temp:    " C_YLW "%.1fC\n" C_RST, w1->temp_now);
-    printf(C_WHT " Feels:   " C_YLW "%.1fC\n" C_RST, w1->feels_like_now);
-    printf(C_WHT " Humidity:" C_CYN "%.0f%%\n" C_RST, w1->humidity_now);
-    printf(C_WHT " Pressure:" C_GRN "%.0fhPa\n" C_RST, w1->pressure_now);
-    printf(C_WHT " Wind:    " C_MAG "%.1fkm/h %s\n" C_RST,
-           w1->wind_now, wind_dir_str(w1->wind_dir_now));
-    printf(C_WHT " UV:      " C_RED "%.1f\n" C_RST, w1->uv_index);
-    printf(C_WHT " Sunrise: " C_YLW "%02d:%02d\n" C_RST,
-           w1->sunrise_hour, w1->sunrise_min);
-    printf(C_WHT " Sunset:  " C_YLW "%02d:%02d\n" C_RST,
-           w1->sunset_hour,  w1->sunset_min);
-    printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " Temp:    " C_YLW "%s\n" C_RST, l1->temp);
+    term_printf(C_WHT " Feels:   " C_YLW "%s\n" C_RST, l1->feels);
+    term_printf(C_WHT " Humidity:" C_CYN "%s\n" C_RST, l1->humidity);
+    term_printf(C_WHT " Pressure:" C_GRN "%shPa\n" C_RST, l1->pressure);
+    term_printf(C_WHT " Wind:    " C_MAG "%skm/h %s\n" C_RST,
+           l1->wind, wind_dir_str(w1->wind_dir_now));
+    term_printf(C_WHT " UV:      " C_RED "%s\n" C_RST, l1->uv);
+    term_printf(C_WHT " Sunrise: " C_YLW "%s\n" C_RST, l1->sunrise);
+    term_printf(C_WHT " Sunset:  " C_YLW "%s\n" C_RST, l1->sunset);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    char dts[12];
     float dt = w1->temp_now - w2->temp_now;
-    if      (dt >  0.05f) printf(C_RED " +%.1fC vs %s\n" C_RST, dt,  c2);
-    else if (dt < -0.05f) printf(C_BLU " %.1fC vs %s\n"  C_RST, dt,  c2);
-    else                   printf(C_GRN " Same temp as %s\n" C_RST,   c2);
-    printf(C_WHT " B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_YLW C_BLD " [2] %s\n" C_RST, c2);
-    printf(C_CYN "================================\n" C_RST);
-    printf(C_YLW "\n %s %s\n\n" C_RST,
+    wxfmt_fixed(dts, dt, 0, 1);
+    if      (dt >  0.05f) term_printf(C_RED " +%sC vs %s\n" C_RST, dts, c2);
+    else if (dt < -0.05f) term_printf(C_BLU " %sC vs %s\n"  C_RST, dts, c2);
+    else                   term_printf(C_GRN " Same temp as %s\n" C_RST,  c2);
+    term_printf(C_WHT " B: back\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_YLW C_BLD " [2] %s\n" C_RST, c2);
+    term_printf(C_CYN "================================\n" C_RST);
+    term_printf(C_YLW "\n %s %s\n\n" C_RST,
            weather_code_icon(w2->weather_code_now),
            weather_code_desc(w2->weather_code_now));
-    printf(C_WHT " Temp:    " C_YLW "%.1fC\n" C_RST, w2->temp_now);
-    printf(C_WHT " Feels:   " C_YLW "%.1fC\n" C_RST, w2->feels_like_now);
-    printf(C_WHT " Humidity:" C_CYN "%.0f%%\n" C_RST, w2->humidity_now);
-    printf(C_WHT " Pressure:" C_GRN "%.0fhPa\n" C_RST, w2->pressure_now);
-    printf(C_WHT " Wind:    " C_MAG "%.1fkm/h %s\n" C_RST,
-           w2->wind_now, wind_dir_str(w2->wind_dir_now));
-    printf(C_WHT " UV:      " C_RED "%.1f\n" C_RST, w2->uv_index);
-    printf(C_WHT " Sunrise: " C_YLW "%02d:%02d\n" C_RST,
-           w2->sunrise_hour, w2->sunrise_min);
-    printf(C_WHT " Sunset:  " C_YLW "%02d:%02d\n" C_RST,
-           w2->sunset_hour,  w2->sunset_min);
-    printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " Temp:    " C_YLW "%s\n" C_RST, l2->temp);
+    term_printf(C_WHT " Feels:   " C_YLW "%s\n" C_RST, l2->feels);
+    term_printf(C_WHT " Humidity:" C_CYN "%s\n" C_RST, l2->humidity);
+    term_printf(C_WHT " Pressure:" C_GRN "%shPa\n" C_RST, l2->pressure);
+    term_printf(C_WHT " Wind:    " C_MAG "%skm/h %s\n" C_RST,
+           l2->wind, wind_dir_str(w2->wind_dir_now));
+    term_printf(C_WHT " UV:      " C_RED "%s\n" C_RST, l2->uv);
+    term_printf(C_WHT " Sunrise: " C_YLW "%s\n" C_RST, l2->sunrise);
+    term_printf(C_WHT " Sunset:  " C_YLW "%s\n" C_RST, l2->sunset);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
     float dt2 = w2->temp_now - w1->temp_now;
-    if      (dt2 >  0.05f) printf(C_RED " +%.1fC vs %s\n" C_RST, dt2, c1);
-    else if (dt2 < -0.05f) printf(C_BLU " %.1fC vs %s\n"  C_RST, dt2, c1);
-    else                    printf(C_GRN " Same temp as %s\n" C_RST,   c1);
+    wxfmt_fixed(dts, dt2, 0, 1);
+    if      (dt2 >  0.05f) term_printf(C_RED " +%sC vs %s\n" C_RST, dts, c1);
+    else if (dt2 < -0.05f) term_printf(C_BLU " %sC vs %s\n"  C_RST, dts, c1);
+    else                    term_printf(C_GRN " Same temp as %s\n" C_RST,  c1);
 }
 
 // ── Schermata crediti ─────────────────────────────────────────────────────
 static void draw_credits(void) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_YLW C_BLD "       3DS WEATHER\n" C_RST);
-    printf(C_CYN "================================\n" C_RST);
-    printf(C_WHT "\n Developer:\n\n" C_RST);
-    printf(C_GRN C_BLD "   Dzhmelyk135\n\n" C_RST);
-    printf(C_WHT " Repository:\n" C_RST);
-    printf(C_CYN "   github.com/\n" C_RST);
-    printf(C_CYN "   Dzhmelyk135/\n" C_RST);
-    printf(C_CYN "   Luma3DSWeather\n\n" C_RST);
-    printf(C_WHT " Weather data:\n" C_RST);
-    printf(C_CYN "   Open-Meteo.com\n\n" C_RST);
-    printf(C_WHT " Geocoding:\n" C_RST);
-    printf(C_CYN "   geocoding-api.\n" C_RST);
-    printf(C_CYN "   open-meteo.com\n" C_RST);
-    printf(C_CYN "\n--------------------------------\n" C_RST);
-    printf(C_WHT " B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    consoleClear();
-    printf(C_CYN C_BLD "================================\n" C_RST);
-    printf(C_MAG C_BLD "       THANKS TO\n" C_RST);
-    printf(C_CYN "================================\n" C_RST);
-    printf(C_WHT "\n Libraries:\n\n" C_RST);
-    printf(C_YLW "   libctru " C_WHT "(devkitPro)\n\n" C_RST);
-    printf(C_YLW "   jsmn    " C_WHT "(Serge Zaitsev)\n\n" C_RST);
-    printf(C_WHT " Tools:\n" C_RST);
-    printf(C_YLW "   devkitARM\n" C_RST);
-    printf(C_YLW "   bannertool\n" C_RST);
-    printf(C_YLW "   makerom\n\n" C_RST);
-    printf(C_CYN " Open-Meteo is free\n" C_RST);
-    printf(C_CYN " and open source!\n" C_RST);
+    term_select(&topScreen);
+    term_clear();
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_YLW C_BLD "       3DS WEATHER\n" C_RST);
+    term_printf(C_CYN "================================\n" C_RST);
+    term_printf(C_WHT "\n Developer:\n\n" C_RST);
+    term_printf(C_GRN C_BLD "   Dzhmelyk135\n\n" C_RST);
+    term_printf(C_WHT " Repository:\n" C_RST);
+    term_printf(C_CYN "   github.com/\n" C_RST);
+    term_printf(C_CYN "   Dzhmelyk135/\n" C_RST);
+    term_printf(C_CYN "   Luma3DSWeather\n\n" C_RST);
+    term_printf(C_WHT " Weather data:\n" C_RST);
+    term_printf(C_CYN "   Open-Meteo.com\n\n" C_RST);
+    term_printf(C_WHT " Geocoding:\n" C_RST);
+    term_printf(C_CYN "   geocoding-api.\n" C_RST);
+    term_printf(C_CYN "   open-meteo.com\n" C_RST);
+    term_printf(C_CYN "\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " B: back\n" C_RST);
+
+    term_select(&botScreen);
+    term_clear();
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_MAG C_BLD "       THANKS TO\n" C_RST);
+    term_printf(C_CYN "================================\n" C_RST);
+    term_printf(C_WHT "\n Libraries:\n\n" C_RST);
+    term_printf(C_YLW "   libctru " C_WHT "(devkitPro)\n\n" C_RST);
+    term_printf(C_YLW "   jsmn    " C_WHT "(Serge Zaitsev)\n\n" C_RST);
+    term_printf(C_WHT " Tools:\n" C_RST);
+    term_printf(C_YLW "   devkitARM\n" C_RST);
+    term_printf(C_YLW "   bannertool\n" C_RST);
+    term_printf(C_YLW "   makerom\n\n" C_RST);
+    term_printf(C_CYN " Open-Meteo is free\n" C_RST);
+    term_printf(C_CYN " and open source!\n" C_RST);
+}
+
+// ── Schermata download ────────────────────────────────────────────────────
+#define PROGRESS_ROW  5
+
+static void draw_loading(const char *city) {
+    term_select(&botScreen);
+    term_clear();
+    term_select(&topScreen);
+    term_clear();
+    term_printf(C_YLW "\n\n %s\n " C_BLD "%s" C_RST C_YLW "...\n" C_RST,
+           T(STR_DOWNLOADING), city);
+    term_printf(C_CYN "\n\n--------------------------------\n" C_RST);
+    term_printf(C_WHT " B: %s\n" C_RST, T(STR_CANCEL));
+}
+
+// Riscrive solo la riga di avanzamento: spinner e byte ricevuti
+static void draw_progress(int frame, u32 received, u32 total) {
+    static const char spin[4] = { '|', '/', '-', '\\' };
+    unsigned rx  = (unsigned)received;
+    unsigned tot = (unsigned)total;
+
+    term_select(&topScreen);
+    term_goto(0, PROGRESS_ROW);
+    term_printf(C_CYN " %c " C_WHT "%u.%u KB", spin[(frame / 8) % 4],
+           rx / 1024, (rx % 1024) * 10 / 1024);
+    if (tot > 0 && rx <= tot)
+        term_printf(C_WHT " / %u KB  " C_GRN "%u%%", (tot + 1023) / 1024,
+               rx * 100 / tot);
+    term_printf(C_RST "          ");
 }
 
 // ── Tastiera software ─────────────────────────────────────────────────────
@@ -589,37 +830,48 @@ static bool get_kb(char *out, int maxlen,
     return (btn == SWKBD_BUTTON_CONFIRM || btn == SWKBD_BUTTON_RIGHT);
 }
 
+// ── Attesa tasto ──────────────────────────────────────────────────────────
+// Per gli avvisi modali: presenta il messaggio e dorme fino al tasto
+static void wait_key(u32 key) {
+    frame_present();
+    while (aptMainLoop()) {
+        hidScanInput();
+        if (hidKeysDown() & key) break;
+        frame_wait(false);
+    }
+}
+
 // ── Avviso WiFi ───────────────────────────────────────────────────────────
 static void show_wifi_error(int code) {
-    consoleSelect(&topScreen);
-    consoleClear();
-    consoleSelect(&botScreen);
-    consoleClear();
-    consoleSelect(&topScreen);
-    printf(C_CYN C_BLD "\n================================\n" C_RST);
-    printf(C_RED C_BLD "      WiFi ERROR\n" C_RST);
-    printf(C_CYN "================================\n\n" C_RST);
-    printf(C_RED " Cannot connect to internet.\n\n" C_RST);
-    printf(C_WHT " Error code: " C_YLW "%d\n\n" C_RST, code);
-    printf(C_WHT " Please check:\n" C_RST);
-    printf(C_WHT "  - WiFi is enabled\n" C_RST);
-    printf(C_WHT "  - You are in range\n" C_RST);
-    printf(C_WHT "  - Internet connection\n" C_RST);
-    printf(C_WHT "    works on 3DS\n\n" C_RST);
-    printf(C_CYN "--------------------------------\n" C_RST);
-    printf(C_WHT " B: back\n" C_RST);
-
-    consoleSelect(&botScreen);
-    printf(C_CYN C_BLD "\n================================\n" C_RST);
-    printf(C_YLW C_BLD "       TIPS\n" C_RST);
-    printf(C_CYN "================================\n\n" C_RST);
-    printf(C_WHT " 1. Go to HOME > System\n" C_RST);
-    printf(C_WHT "    Settings > Internet\n" C_RST);
-    printf(C_WHT "    Settings and connect.\n\n" C_RST);
-    printf(C_WHT " 2. Make sure the WiFi\n" C_RST);
-    printf(C_WHT "    switch is ON.\n\n" C_RST);
-    printf(C_WHT " 3. Try again after\n" C_RST);
-    printf(C_WHT "    connecting.\n" C_RST);
+    term_select(&topScreen);
+    term_clear();
+    term_select(&botScreen);
+    term_clear();
+    term_select(&topScreen);
+    term_printf(C_CYN C_BLD "\n================================\n" C_RST);
+    term_printf(C_RED C_BLD "      WiFi ERROR\n" C_RST);
+    term_printf(C_CYN "================================\n\n" C_RST);
+    term_printf(C_RED " Cannot connect to internet.\n\n" C_RST);
+    term_printf(C_WHT " Error code: " C_YLW "%d\n\n" C_RST, code);
+    term_printf(C_WHT " Please check:\n" C_RST);
+    term_printf(C_WHT "  - WiFi is enabled\n" C_RST);
+    term_printf(C_WHT "  - You are in range\n" C_RST);
+    term_printf(C_WHT "  - Internet connection\n" C_RST);
+    term_printf(C_WHT "    works on 3DS\n\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " B: back\n" C_RST);
+
+    term_select(&botScreen);
+    term_printf(C_CYN C_BLD "\n================================\n" C_RST);
+    term_printf(C_YLW C_BLD "       TIPS\n" C_RST);
+    term_printf(C_CYN "================================\n\n" C_RST);
+    term_printf(C_WHT " 1. Go to HOME > System\n" C_RST);
+    term_printf(C_WHT "    Settings > Internet\n" C_RST);
+    term_printf(C_WHT "    Settings and connect.\n\n" C_RST);
+    term_printf(C_WHT " 2. Make sure the WiFi\n" C_RST);
+    term_printf(C_WHT "    switch is ON.\n\n" C_RST);
+    term_printf(C_WHT " 3. Try again after\n" C_RST);
+    term_printf(C_WHT "    connecting.\n" C_RST);
 }
 
 // ── Main ──────────────────────────────────────────────────────────────────
@@ -630,6 +882,7 @@ int main(int argc, char *argv[]) {
 
     consoleInit(GFX_TOP,    &topScreen);
     consoleInit(GFX_BOTTOM, &botScreen);
+    term_init(&topScreen, &botScreen);
 
     acInit();
     cfguInit();
@@ -637,18 +890,27 @@ int main(int argc, char *argv[]) {
     u32 *socBuf = (u32*)memalign(0x1000, 0x100000);
     socInit(socBuf, 0x100000);
     httpcInit(0x100000);
+    prof_init();
+    weather_init();
 
     mkdir("/3ds/3ds-weather", 0777);
     lang_load();  // imposta EN se primo avvio
+    cache_init();
+    frame_init();
 
     City cities[MAX_CITIES];
     int  cityCount = 0;
     cities_load(cities, &cityCount);
+    vlist_init(&cityView, LIST_ROWS, 1);
+    vlist_init(&hourView, HOUR_ROWS, 1);
+
+    prefetch_cfg_load();
+    if (prefetchOn) prefetch_start(cities, cityCount, 0);
 
     Screen      screen        = SCR_CITY_LIST;
     int         selCity       = 0;
     int         selLang       = (int)currentLang;
-    int         hourOff       = 0;
+    int         graphDay      = 0;
     int         reorderSel    = 0;
     bool        reorderMoving = false;
     bool        redraw        = true;
@@ -662,12 +924,73 @@ int main(int argc, char *argv[]) {
     int  cmpSel2 = 1;
     int  cmpNav  = 0;
 
+    static FetchJob cmpJob[2];
+    int    loadFrame  = 0;
+    Screen lastScreen = screen;
+
     while (aptMainLoop()) {
         hidScanInput();
+        u64 tLoop = prof_now();
         u32 kDown = hidKeysDown();
 
         if (kDown & KEY_START) break;
 
+        // ── Download in background concluso ───────────────────────────
+        if (fetch_done(&job)) {
+            int ret = fetch_finish(&job);
+            bool showing = screen == SCR_LOADING || screen == SCR_CURRENT
+                        || screen == SCR_HOURLY  || screen == SCR_DAILY
+                        || screen == SCR_DETAILS || screen == SCR_GRAPHS;
+            if (ret == 0) {
+                cache_store(&job.city, &job.data);
+                if (showing) {
+                    weather_merge(&wdata, &job.data);
+                    dataStale = cache_expired(&wdata, time(NULL)) != 0;
+                    if (screen == SCR_LOADING) screen = SCR_CURRENT;
+                    redraw = true;
+                }
+            } else if (screen == SCR_LOADING) {
+                if (ret != WEATHER_CANCELLED) {
+                    show_wifi_error(ret);
+                    wait_key(KEY_B);
+                }
+                screen = SCR_CITY_LIST;
+                redraw = true;
+            } else if (showing) {
+                // Si riprova piu' tardi; se manca proprio un blocco
+                // della schermata attuale si torna alla corrente, che
+                // senza le previsioni mostra solo i dati che ha
+                unsigned need = screen_blocks(screen);
+                retryAt = time(NULL) + REFRESH_RETRY;
+                if (screen == SCR_CURRENT) {
+                    redraw = true;
+                } else if ((wdata.blocks & need) != need) {
+                    if (ret != WEATHER_CANCELLED) {
+                        show_wifi_error(ret);
+                        wait_key(KEY_B);
+                    }
+                    screen = SCR_CURRENT;
+                    redraw = true;
+                }
+            }
+        }
+
+        // ── Blocchi mancanti o scaduti ────────────────────────────────
+        unsigned need = screen_blocks(screen);
+        if (screen != lastScreen && (wdata.blocks & need) != need)
+            retryAt = 0;
+        lastScreen = screen;
+        if (need && wdata.valid && job.state == JOB_IDLE
+            && time(NULL) >= retryAt) {
+            // Con durata 0 (sempre vecchi) si aggiorna solo all'apertura
+            unsigned due = cache_ttl() > 0 ? cache_due(&wdata, time(NULL))
+                                           : WEATHER_ALL & ~wdata.blocks;
+            if (due & need) {
+                fetch_start(&job, &cities[selCity], due);
+                if ((wdata.blocks & need) != need) redraw = true;
+            }
+        }
+
         switch (screen) {
 
         // ── Lista citta' ───────────────────────────────────────────────
@@ -682,34 +1005,33 @@ int main(int argc, char *argv[]) {
                 redraw = true;
             }
             if ((kDown & KEY_A) && cityCount > 0) {
-                consoleSelect(&topScreen); consoleClear();
-                consoleSelect(&botScreen); consoleClear();
-                consoleSelect(&topScreen);
-                printf(C_YLW "\n\n %s\n " C_BLD "%s" C_RST
-                       C_YLW "...\n" C_RST,
-                       T(STR_DOWNLOADING), cities[selCity].name);
-                gfxFlushBuffers(); gfxSwapBuffers(); gspWaitForVBlank();
-
-                int ret = weather_fetch(
-                              cities[selCity].lat,
-                              cities[selCity].lon,
-                              cities[selCity].timezone,
-                              &wdata);
-                if (ret == 0) {
+                fetch_abort(&job);
+                CacheState cs = lookup_weather(&cities[selCity], &wdata);
+                time_t now = time(NULL);
+                unsigned expired = cs == CACHE_MISS
+                                 ? 0 : cache_expired(&wdata, now);
+                dataStale = expired != 0;
+                retryAt   = 0;
+                // Senza dati basta la corrente per la prima schermata;
+                // dei dati vecchi si riscaricano solo i blocchi scaduti
+                // (quelli mancanti quando una schermata li mostra)
+                if (cs == CACHE_MISS) {
+                    memset(&wdata, 0, sizeof(wdata));
+                    fetch_start(&job, &cities[selCity], WEATHER_CURRENT);
+                } else if (expired) {
+                    fetch_start(&job, &cities[selCity], expired);
+                }
+                if (cs == CACHE_MISS) {
+                    screen = SCR_LOADING;
+                    loadFrame = 0;
+                    draw_loading(cities[selCity].name);
+                } else {
+                    // Con dati vecchi l'aggiornamento continua in
+                    // background; senza rete restano quelli della cache
                     screen = SCR_CURRENT;
                     draw_current(&wdata, cities[selCity].name);
-                    redraw = false;
-                } else {
-                    show_wifi_error(ret);
-                    gfxFlushBuffers(); gfxSwapBuffers();
-                    while (aptMainLoop()) {
-                        hidScanInput();
-                        if (hidKeysDown() & KEY_B) break;
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        gspWaitForVBlank();
-                    }
-                    redraw = true;
                 }
+                redraw = false;
             }
             if (kDown & KEY_X) {
                 char inp[48]="", found[48]="", tz[40]="Europe/Rome";
@@ -718,33 +1040,24 @@ int main(int argc, char *argv[]) {
                                  T(STR_SEARCH_HINT),
                                  T(STR_CANCEL), T(STR_SEARCH));
                 if (ok && strlen(inp) >= 2) {
-                    consoleSelect(&topScreen); consoleClear();
-                    consoleSelect(&botScreen); consoleClear();
-                    consoleSelect(&topScreen);
-                    printf(C_YLW "\n %s " C_BLD "%s" C_RST "...\n",
+                    term_select(&topScreen); term_clear();
+                    term_select(&botScreen); term_clear();
+                    term_select(&topScreen);
+                    term_printf(C_YLW "\n %s " C_BLD "%s" C_RST "...\n",
                            T(STR_SEARCHING), inp);
-                    gfxFlushBuffers(); gfxSwapBuffers(); gspWaitForVBlank();
+                    frame_present();
                     int ret = weather_geocode(inp,&la,&lo,found,tz);
                     if (ret == 0) {
                         cities_add(cities,&cityCount,found,la,lo,tz);
                         cities_save(cities, cityCount);
-                        printf(C_GRN "\n %s: %s\n" C_RST,
+                        term_printf(C_GRN "\n %s: %s\n" C_RST,
                                T(STR_CITY_ADDED), found);
-                        printf(C_WHT " %.4f, %.4f\n" C_RST, la, lo);
+                        term_printf(C_WHT " %.4f, %.4f\n" C_RST, la, lo);
                     } else {
                         show_wifi_error(ret);
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        while (aptMainLoop()) {
-                            hidScanInput();
-                            if (hidKeysDown() & KEY_B) break;
-                            gfxFlushBuffers(); gfxSwapBuffers();
-                            gspWaitForVBlank();
-                        }
-                    }
-                    for (int f=0;f<60;f++) {
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        gspWaitForVBlank();
+                        wait_key(KEY_B);
                     }
+                    frame_pause(1000);
                 }
                 redraw = true;
             }
@@ -809,19 +1122,29 @@ int main(int argc, char *argv[]) {
                         draw_compare_sel(cities, cityCount,
                                          cmpSel1, cmpSel2, cmpStep);
                     } else {
-                        consoleSelect(&topScreen); consoleClear();
-                        printf(C_RED "\n Need at least 2 cities!\n" C_RST);
-                        printf(C_WHT " B: back\n" C_RST);
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        while (aptMainLoop()) {
-                            hidScanInput();
-                            if (hidKeysDown() & KEY_B) break;
-                            gfxFlushBuffers(); gfxSwapBuffers();
-                            gspWaitForVBlank();
-                        }
+                        term_select(&topScreen); term_clear();
+                        term_printf(C_RED "\n Need at least 2 cities!\n" C_RST);
+                        term_printf(C_WHT " B: back\n" C_RST);
+                        wait_key(KEY_B);
                         draw_menu(menuSel);
                     }
                     break;
+                case MENU_PREFETCH:
+                    prefetchOn = !prefetchOn;
+                    prefetch_cfg_save();
+                    if (prefetchOn)
+                        prefetch_start(cities, cityCount, selCity);
+                    else
+                        prefetch_stop();
+                    draw_menu(menuSel);
+                    break;
+                case MENU_PROFILER:
+                    // Spegnendo l'overlay si salva il riepilogo
+                    profOverlay = !profOverlay;
+                    if (!profOverlay) prof_dump(PROF_CSV_FILE);
+                    profUpdated = 0;
+                    draw_menu(menuSel);
+                    break;
                 case MENU_CREDITS:
                     screen = SCR_CREDITS;
                     draw_credits();
@@ -844,8 +1167,8 @@ int main(int argc, char *argv[]) {
                 draw_city_list(cities, cityCount, selCity);
                 redraw = false;
             } else if (kDown & KEY_L) {
-                hourOff = 0; screen = SCR_HOURLY;
-                draw_hourly(&wdata, cities[selCity].name, hourOff);
+                hourView.top = 0; screen = SCR_HOURLY;
+                draw_hourly(&wdata, cities[selCity].name);
                 redraw = false;
             } else if (kDown & KEY_R) {
                 screen = SCR_DAILY;
@@ -855,6 +1178,10 @@ int main(int argc, char *argv[]) {
                 screen = SCR_DETAILS;
                 draw_details(&wdata, cities[selCity].name);
                 redraw = false;
+            } else if (kDown & KEY_Y) {
+                graphDay = 0; screen = SCR_GRAPHS;
+                draw_graphs(&wdata, cities[selCity].name, graphDay);
+                redraw = false;
             } else if (redraw) {
                 draw_current(&wdata, cities[selCity].name);
                 redraw = false;
@@ -871,14 +1198,14 @@ int main(int argc, char *argv[]) {
                 screen = SCR_DAILY;
                 draw_daily(&wdata, cities[selCity].name);
                 redraw = false;
-            } else if ((kDown & KEY_DOWN) && hourOff < HOURLY_COUNT-12) {
-                hourOff++;
-                draw_hourly(&wdata, cities[selCity].name, hourOff);
-            } else if ((kDown & KEY_UP) && hourOff > 0) {
-                hourOff--;
-                draw_hourly(&wdata, cities[selCity].name, hourOff);
+            } else if (kDown & (KEY_DOWN | KEY_UP | KEY_LEFT | KEY_RIGHT)) {
+                // Una riga con su/giu', un giorno con sinistra/destra
+                int d = (kDown & KEY_DOWN)  ?  1 : (kDown & KEY_UP)   ?  -1
+                      : (kDown & KEY_RIGHT) ? 24 : -24;
+                if (vlist_scroll(&hourView, d))
+                    draw_hourly(&wdata, cities[selCity].name);
             } else if (redraw) {
-                draw_hourly(&wdata, cities[selCity].name, hourOff);
+                draw_hourly(&wdata, cities[selCity].name);
                 redraw = false;
             }
             break;
@@ -890,8 +1217,8 @@ int main(int argc, char *argv[]) {
                 draw_current(&wdata, cities[selCity].name);
                 redraw = false;
             } else if (kDown & KEY_L) {
-                hourOff = 0; screen = SCR_HOURLY;
-                draw_hourly(&wdata, cities[selCity].name, hourOff);
+                hourView.top = 0; screen = SCR_HOURLY;
+                draw_hourly(&wdata, cities[selCity].name);
                 redraw = false;
             } else if (kDown & KEY_X) {
                 screen = SCR_DETAILS;
@@ -915,6 +1242,25 @@ int main(int argc, char *argv[]) {
             }
             break;
 
+        // ── Grafici ───────────────────────────────────────────────────
+        case SCR_GRAPHS:
+            if (kDown & KEY_B) {
+                screen = SCR_CURRENT;
+                draw_current(&wdata, cities[selCity].name);
+                redraw = false;
+            } else if ((kDown & KEY_RIGHT) && graphDay < FORECAST_DAYS-1
+                       && (graphDay+1) * 24 < wdata.hourly_count) {
+                graphDay++;
+                draw_graphs(&wdata, cities[selCity].name, graphDay);
+            } else if ((kDown & KEY_LEFT) && graphDay > 0) {
+                graphDay--;
+                draw_graphs(&wdata, cities[selCity].name, graphDay);
+            } else if (redraw) {
+                draw_graphs(&wdata, cities[selCity].name, graphDay);
+                redraw = false;
+            }
+            break;
+
         // ── Legenda ───────────────────────────────────────────────────
         case SCR_LEGEND:
             if (kDown & KEY_B) {
@@ -1009,61 +1355,28 @@ int main(int argc, char *argv[]) {
                         cmpNav = (cmpNav+1) % cityCount;
                     cmpSel2 = cmpNav;
 
-                    consoleSelect(&topScreen); consoleClear();
-                    consoleSelect(&botScreen); consoleClear();
-                    consoleSelect(&topScreen);
-                    printf(C_YLW "\n Downloading %s...\n" C_RST,
-                           cities[cmpSel1].name);
-                    gfxFlushBuffers(); gfxSwapBuffers(); gspWaitForVBlank();
-
-                    int r1 = weather_fetch(
-                                 cities[cmpSel1].lat,
-                                 cities[cmpSel1].lon,
-                                 cities[cmpSel1].timezone,
-                                 &wdata);
-
-                    if (r1 != 0) {
-                        show_wifi_error(r1);
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        while (aptMainLoop()) {
-                            hidScanInput();
-                            if (hidKeysDown() & KEY_B) break;
-                            gfxFlushBuffers(); gfxSwapBuffers();
-                            gspWaitForVBlank();
-                        }
-                        screen = SCR_CITY_LIST;
-                        redraw = true;
-                        break;
-                    }
-
-                    printf(C_YLW " Downloading %s...\n" C_RST,
-                           cities[cmpSel2].name);
-                    gfxFlushBuffers(); gfxSwapBuffers(); gspWaitForVBlank();
-
-                    int r2 = weather_fetch(
-                                 cities[cmpSel2].lat,
-                                 cities[cmpSel2].lon,
-                                 cities[cmpSel2].timezone,
-                                 &wdata2);
-
-                    if (r2 != 0) {
-                        show_wifi_error(r2);
-                        gfxFlushBuffers(); gfxSwapBuffers();
-                        while (aptMainLoop()) {
-                            hidScanInput();
-                            if (hidKeysDown() & KEY_B) break;
-                            gfxFlushBuffers(); gfxSwapBuffers();
-                            gspWaitForVBlank();
-                        }
-                        screen = SCR_CITY_LIST;
-                        redraw = true;
-                        break;
+                    // Le due citta' si scaricano in parallelo; si
+                    // aspetta in SCR_COMPARE_LOAD che finiscano entrambe
+                    fetch_abort(&job);
+                    dataStale = false;
+                    const City *pair[2] = { &cities[cmpSel1],
+                                            &cities[cmpSel2] };
+                    WeatherData *dst[2] = { &wdata, &wdata2 };
+                    for (int k = 0; k < 2; k++) {
+                        CacheState cs = lookup_weather(pair[k], dst[k]);
+                        if (cs == CACHE_MISS)
+                            memset(dst[k], 0, sizeof(WeatherData));
+                        unsigned due = cache_due(dst[k], time(NULL))
+                                     & COMPARE_BLOCKS;
+                        if (due) fetch_start(&cmpJob[k], pair[k], due);
                     }
 
-                    screen = SCR_COMPARE;
-                    draw_compare(&wdata, &wdata2,
-                                 cities[cmpSel1].name,
-                                 cities[cmpSel2].name);
+                    char both[2 * CITY_NAME_LEN + 4];
+                    snprintf(both, sizeof(both), "%s / %s",
+                             cities[cmpSel1].name, cities[cmpSel2].name);
+                    screen = SCR_COMPARE_LOAD;
+                    loadFrame = 0;
+                    draw_loading(both);
                     redraw = false;
                 }
             } else if (kDown & KEY_B) {
@@ -1079,6 +1392,54 @@ int main(int argc, char *argv[]) {
             }
             break;
 
+        // ── Download confronto ────────────────────────────────────────
+        case SCR_COMPARE_LOAD: {
+            if (kDown & KEY_B) {
+                fetch_cancel(&cmpJob[0]);
+                fetch_cancel(&cmpJob[1]);
+            }
+            u32 rx = 0, tot = 0;
+            bool busy = false;
+            for (int k = 0; k < 2; k++) {
+                if (cmpJob[k].state == JOB_IDLE) continue;
+                rx  += cmpJob[k].ctl.received;
+                tot += cmpJob[k].ctl.total;
+                busy = busy || cmpJob[k].state == JOB_RUNNING;
+            }
+            if (busy) {
+                draw_progress(loadFrame++, rx, tot);
+                break;
+            }
+
+            WeatherData *dst[2] = { &wdata, &wdata2 };
+            int err = 0;
+            for (int k = 0; k < 2; k++) {
+                if (cmpJob[k].state == JOB_IDLE) continue;
+                int r = fetch_finish(&cmpJob[k]);
+                if (r == 0) {
+                    weather_merge(dst[k], &cmpJob[k].data);
+                    cache_store(&cmpJob[k].city, &cmpJob[k].data);
+                } else if (err == 0) {
+                    err = r;
+                }
+            }
+            if (err == 0) {
+                screen = SCR_COMPARE;
+                draw_compare(&wdata, &wdata2,
+                             cities[cmpSel1].name,
+                             cities[cmpSel2].name);
+                redraw = false;
+                break;
+            }
+            if (err != WEATHER_CANCELLED) {
+                show_wifi_error(err);
+                wait_key(KEY_B);
+            }
+            screen = SCR_CITY_LIST;
+            redraw = true;
+            break;
+        }
+
         // ── Confronto ─────────────────────────────────────────────────
         case SCR_COMPARE:
             if (kDown & KEY_B) {
@@ -1093,6 +1454,12 @@ int main(int argc, char *argv[]) {
             }
             break;
 
+        // ── Download ──────────────────────────────────────────────────
+        case SCR_LOADING:
+            if (kDown & KEY_B) fetch_cancel(&job);
+            draw_progress(loadFrame++, job.ctl.received, job.ctl.total);
+            break;
+
         // ── Crediti ───────────────────────────────────────────────────
         case SCR_CREDITS:
             if (kDown & KEY_B) {
@@ -1108,11 +1475,25 @@ int main(int argc, char *argv[]) {
         default: break;
         }
 
-        gfxFlushBuffers();
-        gfxSwapBuffers();
-        gspWaitForVBlank();
+        if (profOverlay) draw_prof_overlay();
+
+        // Solo le schermate di download si animano da sole; si misurano
+        // soltanto i giri che hanno presentato un frame
+        u64 tDraw = prof_now();
+        if (frame_present()) {
+            prof_add_us(PROF_DRAW, prof_ticks_us(tDraw - tLoop));
+            prof_end(PROF_FRAME, tLoop);
+        }
+        frame_wait(screen == SCR_LOADING || screen == SCR_COMPARE_LOAD);
     }
 
+    if (profOverlay) prof_dump(PROF_CSV_FILE);
+
+    fetch_abort(&job);
+    fetch_abort(&cmpJob[0]);
+    fetch_abort(&cmpJob[1]);
+    prefetch_stop();
+    weather_exit();
     httpcExit();
     socExit();
     free(socBuf);
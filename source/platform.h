@@ -0,0 +1,82 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Tipi e primitive di libctru usati dalla logica di rete e di parsing
+// e dal modello a celle dello schermo. Sul 3DS e' semplicemente <3ds.h>;
+// su un PC Linux ne fornisce l'equivalente minimo, cosi' wheather.c,
+// wxparse.c, transport.c e term.c si compilano anche fuori dalla console
+// (vedi Makefile.host).
+
+#ifdef __3DS__
+
+#include <3ds.h>
+
+#else
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+typedef s32      Result;
+
+#define R_SUCCEEDED(res)  ((res) >= 0)
+#define R_FAILED(res)     ((res) < 0)
+
+typedef pthread_mutex_t LightLock;
+
+static inline void LightLock_Init(LightLock *l)   { pthread_mutex_init(l, NULL); }
+static inline void LightLock_Lock(LightLock *l)   { pthread_mutex_lock(l); }
+static inline void LightLock_Unlock(LightLock *l) { pthread_mutex_unlock(l); }
+
+// Millisecondi, usati solo per differenze come sul 3DS
+static inline u64 osGetTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (u64)ts.tv_sec * 1000 + (u64)(ts.tv_nsec / 1000000);
+}
+
+// Tick del contatore di sistema: sul PC sono nanosecondi monotoni
+#define SYSCLOCK_ARM11  1000000000ULL
+
+static inline u64 svcGetSystemTick(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + (u64)ts.tv_nsec;
+}
+
+static inline void svcSleepThread(s64 ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000), (long)(ns % 1000000000) };
+    nanosleep(&ts, NULL);
+}
+
+// Console: solo i campi letti da term.c, framebuffer in memoria
+typedef struct {
+    u8  *gfx;
+    u16  asciiOffset;
+    u16  numChars;
+} ConsoleFont;
+
+typedef struct {
+    ConsoleFont font;
+    int windowWidth, windowHeight;
+} PrintConsole;
+
+typedef enum { GFX_TOP = 0, GFX_BOTTOM = 1 } gfxScreen_t;
+typedef enum { GFX_LEFT = 0, GFX_RIGHT = 1 } gfx3dSide_t;
+
+// Un solo framebuffer per schermo in tutto il programma: le definizioni
+// stanno in tools/platform.c
+u8 *gfxGetFramebuffer(gfxScreen_t screen, gfx3dSide_t side,
+                      u16 *width, u16 *height);
+
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+#include "prefetch.h"
+#include "fetch.h"
+#include <3ds.h>
+#include <string.h>
+#include <time.h>
+
+#define PREFETCH_STACK  (32 * 1024)
+
+typedef struct {
+    City        city;
+    WeatherData data;
+    int         ready;
+} Slot;
+
+static Slot          slots[MAX_CITIES];
+static int           slotCount;
+static int           order[MAX_CITIES];
+static LightLock     lock;
+static Thread        worker;
+static FetchCtl      ctl;
+
+// Citta' da scaricare, nell'ordine di order[]
+static City          batchCity[MAX_CITIES];
+static WeatherData   batchData[MAX_CITIES];
+static int           batchSlot[MAX_CITIES];
+static unsigned      batchDue[MAX_CITIES];
+
+// Gruppo di citta' con gli stessi blocchi da scaricare
+static City          groupCity[MAX_CITIES];
+static WeatherData   groupData[MAX_CITIES];
+static int           groupIdx[MAX_CITIES];
+
+static bool same_city(const City *a, const City *b) {
+    return a->lat == b->lat && a->lon == b->lon
+        && strcmp(a->timezone, b->timezone) == 0;
+}
+
+// ── Thread di prefetch ────────────────────────────────────────────────────
+static void publish(Slot *s, const WeatherData *w) {
+    LightLock_Lock(&lock);
+    s->data  = *w;
+    s->ready = 1;
+    LightLock_Unlock(&lock);
+}
+
+// Prima le citta' gia' in cache; per le altre si scaricano solo i
+// blocchi scaduti o mancanti, con una richiesta per quante citta' con
+// gli stessi blocchi stanno in un URL (weather_fetch_many_blocks).
+// Intanto la citta' resta pubblicata con i dati vecchi.
+static void prefetch_main(void *arg) {
+    int n = 0;
+    time_t now = time(NULL);
+    for (int k = 0; k < slotCount && !ctl.cancel; k++) {
+        Slot *s = &slots[order[k]];
+        WeatherData *w = &batchData[n];
+
+        CacheState cs = cache_load(&s->city, w, NULL);
+        if (cs == CACHE_FRESH) {
+            publish(s, w);
+            continue;
+        }
+        if (cs == CACHE_STALE) publish(s, w);
+        else memset(w, 0, sizeof(*w));
+        batchCity[n] = s->city;
+        batchSlot[n] = order[k];
+        batchDue[n]  = cache_due(w, now);
+        n++;
+    }
+
+    // Un gruppo per ogni combinazione di blocchi, nell'ordine di order[]
+    for (int i = 0; i < n && !ctl.cancel; i++) {
+        unsigned due = batchDue[i];
+        if (!due) continue;
+        int m = 0;
+        for (int j = i; j < n; j++) {
+            if (batchDue[j] != due) continue;
+            groupCity[m] = batchCity[j];
+            groupIdx[m]  = j;
+            batchDue[j]  = 0;
+            m++;
+        }
+        // Senza contesto libero o annullato non si salva nulla del
+        // gruppo; con un altro errore solo le citta' con valid (vedi
+        // weather_fetch_many_blocks), mai i dati del gruppo prima
+        int ret = weather_fetch_many_blocks(groupCity, m, due, groupData,
+                                            &ctl);
+        if (ret == WEATHER_NOMEM || ret == WEATHER_CANCELLED) continue;
+        for (int j = 0; j < m; j++) {
+            if (!groupData[j].valid) continue;
+            int b = groupIdx[j];
+            cache_store(&groupCity[j], &groupData[j]);
+            weather_merge(&batchData[b], &groupData[j]);
+            publish(&slots[batchSlot[b]], &batchData[b]);
+        }
+    }
+}
+
+// ── Avvio / arresto ───────────────────────────────────────────────────────
+// L'ordine segue la probabilita' d'uso: prima la citta' selezionata,
+// poi le vicine alternando sotto e sopra.
+void prefetch_start(const City *list, int count, int first) {
+    prefetch_stop();
+    if (count <= 0) return;
+    if (first < 0 || first >= count) first = 0;
+
+    LightLock_Init(&lock);
+    slotCount = count;
+    for (int i = 0; i < count; i++) {
+        slots[i].city  = list[i];
+        slots[i].ready = 0;
+    }
+    int n = 0;
+    order[n++] = first;
+    for (int d = 1; n < count; d++) {
+        if (first + d < count)  order[n++] = first + d;
+        if (first - d >= 0)     order[n++] = first - d;
+    }
+
+    // Priorita' piu' bassa dell'interfaccia; sul core di sistema se
+    // disponibile, altrimenti sul core dell'applicazione.
+    s32 prio = 0x30;
+    svcGetThreadPriority(&prio, CUR_THREAD_HANDLE);
+    fetchctl_init(&ctl);
+    APT_SetAppCpuTimeLimit(30);
+    worker = threadCreate(prefetch_main, NULL, PREFETCH_STACK,
+                          prio + 1, 1, false);
+    if (!worker)
+        worker = threadCreate(prefetch_main, NULL, PREFETCH_STACK,
+                              prio + 1, -2, false);
+}
+
+void prefetch_stop(void) {
+    if (!worker) return;
+    fetchctl_cancel(&ctl);
+    threadJoin(worker, U64_MAX);
+    threadFree(worker);
+    worker = NULL;
+}
+
+bool prefetch_active(void) {
+    return worker != NULL;
+}
+
+CacheState prefetch_get(const City *c, WeatherData *out) {
+    CacheState cs = CACHE_MISS;
+    if (!worker) return cs;
+
+    LightLock_Lock(&lock);
+    for (int i = 0; i < slotCount; i++) {
+        if (!slots[i].ready || !same_city(&slots[i].city, c)) continue;
+        *out = slots[i].data;
+        cs = cache_state(out, time(NULL));
+        break;
+    }
+    LightLock_Unlock(&lock);
+    return cs;
+}
@@ -0,0 +1,20 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+#include "weather.h"
+#include "cities.h"
+#include "cache.h"
+
+#define PREFETCH_FILE  "/3ds/3ds-weather/prefetch.txt"
+
+// Scaricamento in background di tutte le citta' salvate su un thread
+// separato. Il thread dell'interfaccia non aspetta mai: prefetch_get()
+// copia i dati gia' pronti sotto un LightLock, oppure ritorna CACHE_MISS.
+
+void       prefetch_start(const City *list, int count, int first);
+void       prefetch_stop(void);
+bool       prefetch_active(void);
+CacheState prefetch_get(const City *c, WeatherData *out);
+
+#endif
@@ -0,0 +1,122 @@
+#include "prof.h"
+#include <string.h>
+
+typedef struct {
+    u32 ring[PROF_RING];
+    u32 next;
+    u32 count;
+} ProfRing;
+
+static ProfRing  rings[PROF_COUNT];
+static LightLock profLock;
+
+static const char *names[PROF_COUNT] = {
+    [PROF_FETCH]   = "fetch",
+    [PROF_CONNECT] = "connect",
+    [PROF_RECV]    = "recv",
+    [PROF_PARSE]   = "parse",
+    [PROF_JSMN]    = "jsmn",
+    [PROF_FORMAT]  = "format",
+    [PROF_DRAW]    = "draw",
+    [PROF_TEXT]    = "text",
+    [PROF_CHART]   = "chart",
+    [PROF_FRAME]   = "frame",
+};
+
+void prof_init(void) {
+    LightLock_Init(&profLock);
+    memset(rings, 0, sizeof(rings));
+}
+
+const char *prof_name(ProfSection s) {
+    return (s >= 0 && s < PROF_COUNT) ? names[s] : "?";
+}
+
+u32 prof_ticks_us(u64 ticks) {
+    u64 us = ticks * 1000000ULL / SYSCLOCK_ARM11;
+    return us > 0xFFFFFFFFULL ? 0xFFFFFFFFu : (u32)us;
+}
+
+// ── Misure ────────────────────────────────────────────────────────────────
+void prof_add_us(ProfSection s, u32 us) {
+    if (s < 0 || s >= PROF_COUNT) return;
+    LightLock_Lock(&profLock);
+    ProfRing *r = &rings[s];
+    r->ring[r->next] = us;
+    r->next = (r->next + 1) % PROF_RING;
+    r->count++;
+    LightLock_Unlock(&profLock);
+}
+
+void prof_end(ProfSection s, u64 start) {
+    prof_add_us(s, prof_ticks_us(prof_now() - start));
+}
+
+void prof_reset(void) {
+    LightLock_Lock(&profLock);
+    memset(rings, 0, sizeof(rings));
+    LightLock_Unlock(&profLock);
+}
+
+// ── Statistiche ───────────────────────────────────────────────────────────
+void prof_stats(ProfSection s, ProfStats *out) {
+    u32 v[PROF_RING];
+    memset(out, 0, sizeof(*out));
+    if (s < 0 || s >= PROF_COUNT) return;
+
+    LightLock_Lock(&profLock);
+    const ProfRing *r = &rings[s];
+    u32 n = r->count < PROF_RING ? r->count : PROF_RING;
+    memcpy(v, r->ring, sizeof(v));
+    out->count = r->count;
+    out->last  = n ? r->ring[(r->next + PROF_RING - 1) % PROF_RING] : 0;
+    LightLock_Unlock(&profLock);
+
+    out->samples = n;
+    if (n == 0) return;
+
+    // Anello non ancora pieno: i valori validi sono i primi n
+    u64 sum = 0;
+    for (u32 i = 1; i < n; i++) {
+        u32 x = v[i];
+        u32 j = i;
+        for (; j > 0 && v[j - 1] > x; j--) v[j] = v[j - 1];
+        v[j] = x;
+    }
+    for (u32 i = 0; i < n; i++) sum += v[i];
+    out->min = v[0];
+    out->max = v[n - 1];
+    out->avg = (u32)(sum / n);
+    out->p95 = v[(n * 95 + 99) / 100 - 1];
+}
+
+// ── Uscita ────────────────────────────────────────────────────────────────
+int prof_dump(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "section,count,last_us,min_us,avg_us,p95_us,max_us\n");
+    for (int s = 0; s < PROF_COUNT; s++) {
+        ProfStats st;
+        prof_stats((ProfSection)s, &st);
+        fprintf(f, "%s,%lu,%lu,%lu,%lu,%lu,%lu\n", names[s],
+                (unsigned long)st.count, (unsigned long)st.last,
+                (unsigned long)st.min, (unsigned long)st.avg,
+                (unsigned long)st.p95, (unsigned long)st.max);
+    }
+    fclose(f);
+    return 0;
+}
+
+void prof_print(FILE *f) {
+    fprintf(f, "%-8s %6s %9s %9s %9s %9s\n",
+            "section", "count", "min_us", "avg_us", "p95_us", "max_us");
+    for (int s = 0; s < PROF_COUNT; s++) {
+        ProfStats st;
+        prof_stats((ProfSection)s, &st);
+        if (!st.count) continue;
+        fprintf(f, "%-8s %6lu %9lu %9lu %9lu %9lu\n", names[s],
+                (unsigned long)st.count, (unsigned long)st.min,
+                (unsigned long)st.avg, (unsigned long)st.p95,
+                (unsigned long)st.max);
+    }
+}
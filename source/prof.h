@@ -0,0 +1,65 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include "platform.h"
+#include <stdio.h>
+
+// Misure dei tempi per sezione, basate su svcGetSystemTick(): ogni
+// sezione tiene le ultime PROF_RING durate (in microsecondi) da cui si
+// ricavano minimo, media e 95-esimo percentile. Si puo' misurare da
+// qualsiasi thread. Sul PC il contatore e' clock_gettime (platform.h),
+// quindi wxhost e i benchmark in tools/ riportano le stesse sezioni.
+
+#define PROF_RING      64
+#define PROF_CSV_FILE  "/3ds/3ds-weather/profile.csv"
+
+typedef enum {
+    PROF_FETCH,      // weather_fetch_ctl() completa
+    PROF_CONNECT,    // apertura, richiesta e intestazioni della risposta
+    PROF_RECV,       // lettura del corpo (senza il parsing)
+    PROF_PARSE,      // estrattore a flusso, per risposta
+    PROF_JSMN,       // jsmn_parse() del geocoding
+    PROF_FORMAT,     // wxfmt_build()
+    PROF_DRAW,       // input e draw_* di un giro del ciclo principale
+    PROF_TEXT,       // term_flush(): celle cambiate nel framebuffer
+    PROF_CHART,      // chart_draw()
+    PROF_FRAME,      // giro del ciclo principale, attesa esclusa
+    PROF_COUNT
+} ProfSection;
+
+typedef struct {
+    u32 count;       // misure dall'avvio
+    u32 samples;     // misure nell'anello (<= PROF_RING)
+    u32 last, min, avg, p95, max;   // microsecondi, sull'anello
+} ProfStats;
+
+void        prof_init(void);
+static inline u64 prof_now(void) { return svcGetSystemTick(); }
+// Aggiunge la durata trascorsa da start (un valore di prof_now())
+void        prof_end(ProfSection s, u64 start);
+void        prof_add_us(ProfSection s, u32 us);
+u32         prof_ticks_us(u64 ticks);
+void        prof_stats(ProfSection s, ProfStats *out);
+const char *prof_name(ProfSection s);
+void        prof_reset(void);
+// Riepilogo CSV (sezione,count,last_us,min_us,avg_us,p95_us,max_us)
+int         prof_dump(const char *path);
+// Tabella delle sezioni con almeno una misura
+void        prof_print(FILE *f);
+
+// Misura il resto del blocco in cui compare:
+//   { PROF_SCOPE(PROF_DRAW); draw_current(...); }
+typedef struct {
+    ProfSection s;
+    u64         start;
+} ProfScope;
+
+static inline void prof_scope_end(ProfScope *p) { prof_end(p->s, p->start); }
+
+#define PROF_CAT_(a, b)  a##b
+#define PROF_CAT(a, b)   PROF_CAT_(a, b)
+#define PROF_SCOPE(sec) \
+    ProfScope PROF_CAT(prof_scope_, __LINE__) \
+        __attribute__((cleanup(prof_scope_end))) = { (sec), prof_now() }
+
+#endif
@@ -0,0 +1,97 @@
+#include "render.h"
+#include <string.h>
+
+#define RGB565(r, g, b)  ((u16)((((r) >> 3) << 11) | (((g) >> 2) << 5) \
+                                | ((b) >> 3)))
+
+// Stessa tavolozza della console di libctru
+static const u16 palette[16] = {
+    RGB565(  0,   0,   0), RGB565(128,   0,   0),
+    RGB565(  0, 128,   0), RGB565(128, 128,   0),
+    RGB565(  0,   0, 128), RGB565(128,   0, 128),
+    RGB565(  0, 128, 128), RGB565(192, 192, 192),
+    RGB565(128, 128, 128), RGB565(255,   0,   0),
+    RGB565(  0, 255,   0), RGB565(255, 255,   0),
+    RGB565(  0,   0, 255), RGB565(255,   0, 255),
+    RGB565(  0, 255, 255), RGB565(255, 255, 255),
+};
+
+// Per ogni glifo la maschera di ciascuna colonna, bit 0 = pixel in basso
+// (il primo in memoria); per ogni colore le 4 coppie di pixel possibili
+// su sfondo nero, pronte per uno store a 32 bit.
+static u8   atlas[256][8];
+static u32  pairs[16][4];
+
+static u16 *target;
+static int  tcols, trows;
+
+void render_init(const u8 *font, int first, int count) {
+    memset(atlas, 0, sizeof(atlas));
+    for (int g = 0; g < count && first + g < 256; g++) {
+        const u8 *rows = font + g * 8;
+        u8 *cols = atlas[first + g];
+        for (int c = 0; c < 8; c++) {
+            u8 m = 0;
+            for (int r = 0; r < 8; r++)
+                if (rows[r] & (0x80 >> c)) m |= (u8)(1 << (7 - r));
+            cols[c] = m;
+        }
+    }
+
+    u32 bg = palette[RC_BLACK];
+    for (int i = 0; i < 16; i++) {
+        u32 fg = palette[i];
+        pairs[i][0] = bg | (bg << 16);
+        pairs[i][1] = fg | (bg << 16);
+        pairs[i][2] = bg | (fg << 16);
+        pairs[i][3] = fg | (fg << 16);
+    }
+}
+
+void render_target(u16 *fb, int cols, int rows) {
+    target = fb;
+    tcols  = cols;
+    trows  = rows;
+}
+
+// Primo word della cella (x, y): colonna x*8, riga piu' bassa del glifo
+static inline u32 *cell_addr(int x, int y) {
+    return (u32*)(target + x * 8 * RENDER_FB_HEIGHT
+                         + (RENDER_FB_HEIGHT - 8 - y * 8));
+}
+
+static inline void blit(u32 *dst, const u8 *cols, const u32 *pc) {
+    for (int c = 0; c < 8; c++) {
+        u32 m = cols[c];
+        dst[0] = pc[m & 3];
+        dst[1] = pc[(m >> 2) & 3];
+        dst[2] = pc[(m >> 4) & 3];
+        dst[3] = pc[m >> 6];
+        dst += RENDER_FB_HEIGHT / 2;
+    }
+}
+
+void render_text(int x, int y, const char *s, int n, int color) {
+    if (!target || y < 0 || y >= trows || x < 0) return;
+    if (n > tcols - x) n = tcols - x;
+
+    const u32 *pc  = pairs[color & 15];
+    u32       *dst = cell_addr(x, y);
+    for (int i = 0; i < n; i++) {
+        blit(dst, atlas[(u8)s[i]], pc);
+        dst += 8 * RENDER_FB_HEIGHT / 2;
+    }
+}
+
+void render_bar(int x, int y, int len, int fill, int color) {
+    if (!target || y < 0 || y >= trows || x < 0) return;
+    if (len > tcols - x) len = tcols - x;
+    if (fill > len) fill = len;
+
+    u32 *dst = cell_addr(x, y);
+    for (int i = 0; i < len; i++) {
+        if (i < fill) blit(dst, atlas['#'], pairs[color & 15]);
+        else          blit(dst, atlas['-'], pairs[RC_WHITE]);
+        dst += 8 * RENDER_FB_HEIGHT / 2;
+    }
+}
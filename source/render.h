@@ -0,0 +1,35 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "platform.h"
+
+// Disegno di glifi 8x8 direttamente nel framebuffer RGB565 della
+// console. Il framebuffer del 3DS e' ruotato: ogni colonna di pixel
+// (240) e' contigua in memoria, dal basso verso l'alto, quindi una
+// colonna di glifo sono 16 byte scritti con 4 store a 32 bit.
+
+#define RENDER_FB_HEIGHT  240
+
+// Colori come nella console: 0-7 ANSI, + RC_BRIGHT per il grassetto
+enum {
+    RC_BLACK = 0,
+    RC_RED,
+    RC_GREEN,
+    RC_YELLOW,
+    RC_BLUE,
+    RC_MAGENTA,
+    RC_CYAN,
+    RC_WHITE,
+    RC_BRIGHT = 8
+};
+
+// font: count glifi da 8 byte (una riga per byte, bit 7 a sinistra)
+// a partire dal carattere first, come ConsoleFont di libctru
+void render_init(const u8 *font, int first, int count);
+// Framebuffer di destinazione, dimensioni in celle da 8x8
+void render_target(u16 *fb, int cols, int rows);
+void render_text(int x, int y, const char *s, int n, int color);
+// Barra di len celle: fill '#' nel colore dato, il resto '-' in bianco
+void render_bar(int x, int y, int len, int fill, int color);
+
+#endif
@@ -0,0 +1,272 @@
+#include "snapshot.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Intestazione:
+//   0  'W' 'X'        magic
+//   2  u8             versione
+//   3  u8             ore nella serie oraria
+//   4  u8             giorni nella serie giornaliera
+//   5  u8             blocchi presenti (WEATHER_*)
+//   6  u16            lunghezza del payload
+//   8  u16            CRC-16/CCITT di intestazione (byte 0-7) e payload
+//
+// Payload: ora del download di ogni blocco (u32, secondi dal 1970, 0 se
+// manca), blocco corrente (19 byte), temperatura della prima ora (s16),
+// 4 byte per ora, 13 per giorno. I blocchi mancanti si scrivono a zero.
+//
+// Ora: s8 differenza di temperatura dall'ora prima in decimi, u8
+// pioggia, u8 umidita', u8 codice. La differenza e' limitata a +-12.7
+// gradi: l'errore di un salto piu' grande si recupera nelle ore dopo,
+// perche' il codificatore parte sempre dal valore che leggera' il
+// decodificatore. La pioggia e' in decimi fino a 10 mm, poi in mm
+// (PRECIP_STEP), fino a 165 mm.
+// Alba e tramonto non si salvano: si ricalcolano dalle coordinate
+// (weather_sun); resta l'offset UTC in quarti d'ora, che serve per i
+// fusi fuori da tz.c.
+
+// ── Scrittura / lettura little-endian ─────────────────────────────────────
+typedef struct {
+    unsigned char       *p;
+    const unsigned char *r;
+} Cursor;
+
+static void put_u8(Cursor *c, int v) {
+    *c->p++ = (unsigned char)v;
+}
+
+static void put_u16(Cursor *c, int v) {
+    c->p[0] = (unsigned char)(v & 0xFF);
+    c->p[1] = (unsigned char)((v >> 8) & 0xFF);
+    c->p += 2;
+}
+
+static void put_u32(Cursor *c, unsigned long v) {
+    put_u16(c, (int)(v & 0xFFFF));
+    put_u16(c, (int)((v >> 16) & 0xFFFF));
+}
+
+static int get_u8(Cursor *c) {
+    return *c->r++;
+}
+
+static int get_s8(Cursor *c) {
+    int v = get_u8(c);
+    return v >= 0x80 ? v - 0x100 : v;
+}
+
+static int get_u16(Cursor *c) {
+    int v = c->r[0] | (c->r[1] << 8);
+    c->r += 2;
+    return v;
+}
+
+static int get_s16(Cursor *c) {
+    int v = get_u16(c);
+    return v >= 0x8000 ? v - 0x10000 : v;
+}
+
+static unsigned long get_u32(Cursor *c) {
+    unsigned long lo = (unsigned long)get_u16(c);
+    return lo | ((unsigned long)get_u16(c) << 16);
+}
+
+static void get_date(Cursor *c, char *out, int size) {
+    int y = get_u16(c);
+    int m = get_u8(c);
+    int d = get_u8(c);
+    if (y > 0)
+        snprintf(out, size, "%04d-%02d-%02d", y % 10000, m % 100, d % 100);
+}
+
+// ── Quantizzazione ────────────────────────────────────────────────────────
+static int q10(float x, int lo, int hi) {
+    long v = lroundf(x * 10.f);
+    return v < lo ? lo : v > hi ? hi : (int)v;
+}
+
+static int q1(float x, int lo, int hi) {
+    long v = lroundf(x);
+    return v < lo ? lo : v > hi ? hi : (int)v;
+}
+
+static int clampi(int v, int lo, int hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// "YYYY-MM-DD" come u16 anno, u8 mese, u8 giorno; 0 se manca
+static void put_date(Cursor *c, const char *s) {
+    int y = 0, m = 0, d = 0;
+    sscanf(s, "%d-%d-%d", &y, &m, &d);
+    put_u16(c, clampi(y, 0, 65535));
+    put_u8 (c, clampi(m, 0, 255));
+    put_u8 (c, clampi(d, 0, 255));
+}
+
+#define S16(x)  q10(x, -32768, 32767)
+#define U16(x)  q10(x, 0, 65535)
+
+_Static_assert(SNAPSHOT_MAX_SIZE <= SNAPSHOT_LIMIT,
+               "snapshot di una citta' oltre SNAPSHOT_LIMIT");
+
+// Pioggia oraria in un byte: decimi fino a PRECIP_STEP, poi mm interi
+#define PRECIP_STEP  100
+
+static int precip_q(float mm) {
+    int v = q10(mm, 0, 65535);
+    if (v <= PRECIP_STEP) return v;
+    // Dai mm, non dai decimi gia' arrotondati
+    return PRECIP_STEP + q1(mm - PRECIP_STEP / 10.f, 0, 255 - PRECIP_STEP);
+}
+
+static float precip_mm(int v) {
+    if (v <= PRECIP_STEP) return v / 10.f;
+    return (PRECIP_STEP + (v - PRECIP_STEP) * 10) / 10.f;
+}
+
+static unsigned short crc16(const unsigned char *d, int len,
+                            unsigned short crc) {
+    for (int i = 0; i < len; i++) {
+        crc ^= (unsigned short)(d[i] << 8);
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021)
+                                 : (unsigned short)(crc << 1);
+    }
+    return crc;
+}
+
+// ── Codifica ──────────────────────────────────────────────────────────────
+int snapshot_encode(const WeatherData *w, unsigned char *buf, int cap) {
+    if (cap < SNAPSHOT_MAX_SIZE) return -1;
+
+    Cursor c = { buf + SNAPSHOT_HDR_SIZE, NULL };
+    unsigned blocks = w->blocks & WEATHER_ALL;
+
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        put_u32(&c, (blocks & (1u << b)) && w->fetched[b] > 0
+                    ? (unsigned long)w->fetched[b] : 0);
+
+    put_u16(&c, S16(w->temp_now));
+    put_u16(&c, S16(w->feels_like_now));
+    put_u16(&c, U16(w->wind_now));
+    put_u16(&c, clampi(w->wind_dir_now, 0, 65535));
+    put_u16(&c, U16(w->pressure_now));
+    put_u8 (&c, q1(w->humidity_now, 0, 255));
+    put_u8 (&c, clampi(w->weather_code_now, 0, 255));
+    put_u8 (&c, clampi(w->current_hour, 0, 255));
+    put_u8 (&c, q10(w->uv_index, 0, 255));
+    put_u8 (&c, clampi(w->utc_offset / 900, -128, 127) & 0xFF);
+    put_date(&c, w->current_date);
+
+    int hours = clampi(w->hourly_count, 0, HOURLY_COUNT);
+    int prev  = hours ? S16(w->hourly_temp[0]) : 0;
+    put_u16(&c, prev);
+    for (int i = 0; i < hours; i++) {
+        int d = clampi(S16(w->hourly_temp[i]) - prev, -128, 127);
+        prev += d;
+        put_u8 (&c, d & 0xFF);
+        put_u8 (&c, precip_q(w->hourly_precip[i]));
+        put_u8 (&c, q1(w->hourly_humidity[i], 0, 255));
+        put_u8 (&c, clampi(w->hourly_code[i], 0, 255));
+    }
+
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        put_date(&c, w->daily_date[i]);
+        put_u16(&c, S16(w->daily_max[i]));
+        put_u16(&c, S16(w->daily_min[i]));
+        put_u16(&c, U16(w->daily_precip[i]));
+        put_u16(&c, U16(w->daily_wind_max[i]));
+        put_u8 (&c, clampi(w->daily_code[i], 0, 255));
+    }
+
+    int plen = (int)(c.p - buf) - SNAPSHOT_HDR_SIZE;
+    c.p = buf;
+    put_u8 (&c, 'W');
+    put_u8 (&c, 'X');
+    put_u8 (&c, SNAPSHOT_VERSION);
+    put_u8 (&c, hours);
+    put_u8 (&c, FORECAST_DAYS);
+    put_u8 (&c, blocks);
+    put_u16(&c, plen);
+    unsigned short crc = crc16(buf, 8, 0xFFFF);
+    crc = crc16(buf + SNAPSHOT_HDR_SIZE, plen, crc);
+    put_u16(&c, crc);
+
+    return SNAPSHOT_HDR_SIZE + plen;
+}
+
+// ── Decodifica ────────────────────────────────────────────────────────────
+int snapshot_decode(const unsigned char *buf, int len, WeatherData *out) {
+    if (len < SNAPSHOT_HDR_SIZE) return -1;
+
+    Cursor c = { NULL, buf };
+    if (get_u8(&c) != 'W' || get_u8(&c) != 'X') return -1;
+    if (get_u8(&c) != SNAPSHOT_VERSION)         return -1;
+    int hours = get_u8(&c);
+    int days  = get_u8(&c);
+    int blocks = get_u8(&c);
+    int plen  = get_u16(&c);
+    int crc   = get_u16(&c);
+
+    if (plen != SNAPSHOT_META_SIZE + SNAPSHOT_CUR_SIZE + SNAPSHOT_BASE_SIZE
+                + hours * SNAPSHOT_HOUR_SIZE
+                + days * SNAPSHOT_DAY_SIZE)        return -1;
+    if (SNAPSHOT_HDR_SIZE + plen > len)           return -1;
+    unsigned short chk = crc16(buf, 8, 0xFFFF);
+    if (crc16(buf + SNAPSHOT_HDR_SIZE, plen, chk) != crc) return -1;
+
+    WeatherData *w = out;
+    memset(w, 0, sizeof(*w));
+
+    w->blocks = blocks & WEATHER_ALL;
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        w->fetched[b] = (time_t)get_u32(&c);
+
+    w->temp_now         = get_s16(&c) / 10.f;
+    w->feels_like_now   = get_s16(&c) / 10.f;
+    w->wind_now         = get_u16(&c) / 10.f;
+    w->wind_dir_now     = get_u16(&c);
+    w->pressure_now     = get_u16(&c) / 10.f;
+    w->humidity_now     = (float)get_u8(&c);
+    w->weather_code_now = get_u8(&c);
+    w->current_hour     = get_u8(&c);
+    w->uv_index         = get_u8(&c) / 10.f;
+    w->utc_offset       = get_s8(&c) * 900;
+    get_date(&c, w->current_date, sizeof(w->current_date));
+    w->hourly_count     = hours < HOURLY_COUNT ? hours : HOURLY_COUNT;
+
+    int prev = get_s16(&c);
+    for (int i = 0; i < hours; i++) {
+        prev += get_s8(&c);
+        float t = prev / 10.f;
+        float p = precip_mm(get_u8(&c));
+        float h = (float)get_u8(&c);
+        int   k = get_u8(&c);
+        if (i >= HOURLY_COUNT) continue;
+        w->hourly_temp[i]     = t;
+        w->hourly_precip[i]   = p;
+        w->hourly_humidity[i] = h;
+        w->hourly_code[i]     = k;
+    }
+
+    for (int i = 0; i < days; i++) {
+        char date[12] = "";
+        get_date(&c, date, sizeof(date));
+        float mx = get_s16(&c) / 10.f;
+        float mn = get_s16(&c) / 10.f;
+        float pr = get_u16(&c) / 10.f;
+        float wm = get_u16(&c) / 10.f;
+        int   k  = get_u8(&c);
+        if (i >= FORECAST_DAYS) continue;
+        memcpy(w->daily_date[i], date, sizeof(date));
+        w->daily_max[i]      = mx;
+        w->daily_min[i]      = mn;
+        w->daily_precip[i]   = pr;
+        w->daily_wind_max[i] = wm;
+        w->daily_code[i]     = k;
+    }
+
+    w->valid = w->blocks != 0;
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "weather.h"
+
+// Formato binario compatto e versionato di WeatherData (little-endian).
+// Temperature, vento, pressione, pioggia e UV sono in decimi (interi a
+// 16/8 bit), codici WMO e umidita' in un byte. Le dimensioni delle serie
+// sono scritte nell'intestazione, quindi un cambio di HOURLY_COUNT o
+// FORECAST_DAYS non invalida gli snapshot gia' salvati. Della serie
+// oraria si salvano solo le hourly_count ore ricevute, a 4 byte l'ora:
+// la temperatura come differenza dall'ora prima. Ogni blocco conserva
+// la sua ora di download. Con 7 giorni di serie oraria uno snapshot
+// resta sotto SNAPSHOT_LIMIT (verificato in compilazione).
+
+#define SNAPSHOT_VERSION   4
+#define SNAPSHOT_HDR_SIZE  10
+#define SNAPSHOT_META_SIZE (WEATHER_BLOCKS * 4)
+#define SNAPSHOT_CUR_SIZE  19
+#define SNAPSHOT_BASE_SIZE 2     // temperatura della prima ora
+#define SNAPSHOT_HOUR_SIZE 4
+#define SNAPSHOT_DAY_SIZE  13
+#define SNAPSHOT_MAX_SIZE  (SNAPSHOT_HDR_SIZE + SNAPSHOT_META_SIZE \
+                            + SNAPSHOT_CUR_SIZE + SNAPSHOT_BASE_SIZE \
+                            + HOURLY_COUNT  * SNAPSHOT_HOUR_SIZE \
+                            + FORECAST_DAYS * SNAPSHOT_DAY_SIZE)
+#define SNAPSHOT_LIMIT     1024
+
+int snapshot_encode(const WeatherData *w, unsigned char *buf, int cap);
+int snapshot_decode(const unsigned char *buf, int len, WeatherData *out);
+
+#endif
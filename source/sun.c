@@ -0,0 +1,106 @@
+#include "sun.h"
+#include <math.h>
+
+#define RAD  0.017453292f
+#define DEG  57.29577951f
+
+// Giorni dal 2000-01-01 (calendario gregoriano)
+static s32 days_2000(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468 - 10957;
+}
+
+// Declinazione (gradi) ed equazione del tempo (minuti) a j giorni da
+// J2000.0. Gli angoli si riducono prima dei seni: in precisione singola
+// un argomento di decine di migliaia di gradi perderebbe i decimali.
+static void solar(float j, float *decl, float *eot) {
+    float t  = j / 36525.f;
+    float l0 = fmodf(280.46646f + 0.98564736f * j
+                     + 0.0003032f * t * t, 360.f);
+    float m  = fmodf(357.52911f + 0.98560028f * j
+                     - 0.0001537f * t * t, 360.f);
+    float e  = 0.016708634f - t * (0.000042037f + 0.0000001267f * t);
+    float om = fmodf(125.04f - 0.05295377f * j, 360.f);
+
+    float mr = m * RAD;
+    float c  = sinf(mr) * (1.914602f - t * (0.004817f + 0.000014f * t))
+             + sinf(2 * mr) * (0.019993f - 0.000101f * t)
+             + sinf(3 * mr) * 0.000289f;
+    float lambda = l0 + c - 0.00569f - 0.00478f * sinf(om * RAD);
+
+    float eps0 = 23.f + (26.f + (21.448f - t * (46.815f + t * (0.00059f
+                 - t * 0.001813f))) / 60.f) / 60.f;
+    float eps  = eps0 + 0.00256f * cosf(om * RAD);
+    *decl = asinf(sinf(eps * RAD) * sinf(lambda * RAD)) * DEG;
+
+    float y   = tanf(eps * RAD / 2);
+    float l2  = 2 * l0 * RAD;
+    y *= y;
+    *eot = 4.f * DEG * (y * sinf(l2) - 2 * e * sinf(mr)
+                        + 4 * e * y * sinf(mr) * cosf(l2)
+                        - 0.5f * y * y * sinf(2 * l2)
+                        - 1.25f * e * e * sinf(2 * mr));
+}
+
+// Angolo orario dell'alba (gradi); > 180 o < 0 nei giorni polari
+static float hour_angle(float lat, float decl) {
+    float h = cosf(90.833f * RAD) / (cosf(lat * RAD) * cosf(decl * RAD))
+            - tanf(lat * RAD) * tanf(decl * RAD);
+    if (h >  1.f) return -1.f;
+    if (h < -1.f) return 181.f;
+    return acosf(h) * DEG;
+}
+
+// Istante dell'evento (minuti UTC dalla mezzanotte del giorno day):
+// stima dalla posizione a mezzogiorno, poi ricalcolo a quell'istante
+static float event(float lat, float lon, s32 day, float noon, int dir,
+                   float *ha) {
+    float at = noon;
+    for (int pass = 0; pass < 2; pass++) {
+        float decl, eot;
+        solar(day - 0.5f + at / 1440.f, &decl, &eot);
+        *ha = hour_angle(lat, decl);
+        if (*ha < 0.f || *ha > 180.f) return noon;
+        at = 720.f - 4.f * lon - eot + dir * 4.f * *ha;
+    }
+    return at;
+}
+
+static s16 wrap_min(float local) {
+    int m = (int)floorf(local + 0.5f) % 1440;
+    return (s16)(m < 0 ? m + 1440 : m);
+}
+
+int sun_day(float lat, float lon, int y, int m, int d, s32 offset,
+            SunDay *out) {
+    float off = offset / 60.f;
+    s32   day = days_2000(y, m, d);
+
+    // Mezzogiorno solare nel giorno UTC che contiene quello locale
+    float decl, eot;
+    float noon = 720.f - 4.f * lon;
+    if (noon + off > 1440.f + 720.f) day--;
+    else if (noon + off < -720.f)    day++;
+    solar(day - 0.5f + noon / 1440.f, &decl, &eot);
+    noon -= eot;
+
+    float hr, hs;
+    float rise = event(lat, lon, day, noon, -1, &hr);
+    float set  = event(lat, lon, day, noon, +1, &hs);
+
+    if (hr > 180.f || hs > 180.f || hr < 0.f || hs < 0.f) {
+        bool polar_day = hr > 180.f || hs > 180.f;
+        out->rise   = SUN_NONE;
+        out->set    = SUN_NONE;
+        out->length = polar_day ? 1440 : 0;
+        return polar_day ? SUN_POLAR_DAY : SUN_POLAR_NIGHT;
+    }
+    out->rise   = wrap_min(rise + off);
+    out->set    = wrap_min(set + off);
+    out->length = (s16)floorf(set - rise + 0.5f);
+    return SUN_NORMAL;
+}
@@ -0,0 +1,30 @@
+#ifndef SUN_H
+#define SUN_H
+
+#include "platform.h"
+
+// Alba e tramonto calcolati sulla console con le formule NOAA (quelle
+// del foglio di calcolo "Solar Calculations", in precisione singola):
+// posizione del sole a mezzogiorno, poi una correzione all'istante di
+// ciascun evento. Errore tipico sotto il minuto alle latitudini
+// abitate; verifica su PC con tools/suncheck.c.
+
+#define SUN_NONE  (-1)
+
+enum {
+    SUN_NORMAL = 0,
+    SUN_POLAR_DAY,      // il sole non tramonta
+    SUN_POLAR_NIGHT     // il sole non sorge
+};
+
+typedef struct {
+    s16 rise;           // minuti dalla mezzanotte locale, o SUN_NONE
+    s16 set;
+    s16 length;         // durata del giorno in minuti
+} SunDay;
+
+// Giorno y-m-d nel fuso con offset secondi a est di UTC; ritorna SUN_*
+int sun_day(float lat, float lon, int y, int m, int d, s32 offset,
+            SunDay *out);
+
+#endif
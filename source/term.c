@@ -0,0 +1,248 @@
+#include "term.h"
+#include "render.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+// Attributo: colore di primo piano ANSI (0-7) piu' il bit grassetto,
+// nella stessa codifica dei colori di render.h
+#define ATTR_BOLD     RC_BRIGHT
+#define ATTR_DEFAULT  RC_WHITE
+
+typedef struct {
+    u8 ch;
+    u8 attr;
+} Cell;
+
+typedef struct {
+    PrintConsole *con;
+    gfxScreen_t   gfx;
+    int   cols, rows;
+    int   x, y;
+    u8    attr;
+    bool  dirty;
+    int   rx, ry, rw, rh;    // celle riservate (vedi term_reserve)
+    Cell  want[TERM_MAX_ROWS][TERM_MAX_COLS];
+    Cell  shown[TERM_MAX_ROWS][TERM_MAX_COLS];
+} TermScreen;
+
+static TermScreen screens[2];
+static TermScreen *cur = &screens[0];
+
+static void screen_init(TermScreen *s, PrintConsole *con, gfxScreen_t gfx) {
+    s->con  = con;
+    s->gfx  = gfx;
+    s->cols = con->windowWidth  < TERM_MAX_COLS ? con->windowWidth
+                                                : TERM_MAX_COLS;
+    s->rows = con->windowHeight < TERM_MAX_ROWS ? con->windowHeight
+                                                : TERM_MAX_ROWS;
+    // Dopo consoleInit lo schermo e' vuoto
+    for (int r = 0; r < TERM_MAX_ROWS; r++)
+        for (int c = 0; c < TERM_MAX_COLS; c++) {
+            s->want[r][c]  = (Cell){ ' ', 0 };
+            s->shown[r][c] = (Cell){ ' ', 0 };
+        }
+    s->x = s->y = 0;
+    s->attr  = ATTR_DEFAULT;
+    s->dirty = false;
+    s->rw = s->rh = 0;
+}
+
+void term_init(PrintConsole *top, PrintConsole *bot) {
+    screen_init(&screens[0], top, GFX_TOP);
+    screen_init(&screens[1], bot, GFX_BOTTOM);
+    render_init(top->font.gfx, top->font.asciiOffset, top->font.numChars);
+    cur = &screens[0];
+}
+
+void term_select(PrintConsole *con) {
+    cur = (con == screens[1].con) ? &screens[1] : &screens[0];
+}
+
+// ── Celle riservate ───────────────────────────────────────────────────────
+// Un rettangolo disegnato da altri direttamente nel framebuffer: il flush
+// lo salta, e quando viene restituito il contenuto mostrato diventa
+// sconosciuto, cosi' il flush successivo lo ridisegna.
+void term_reserve(int x, int y, int w, int h) {
+    cur->rx = x;
+    cur->ry = y;
+    cur->rw = w;
+    cur->rh = h;
+}
+
+static void release(TermScreen *s) {
+    for (int r = s->ry; r < s->ry + s->rh && r < s->rows; r++)
+        for (int c = s->rx; c < s->rx + s->rw && c < s->cols; c++)
+            s->shown[r][c] = (Cell){ 0, 0xFF };
+    s->rw = s->rh = 0;
+}
+
+static inline bool reserved(const TermScreen *s, int r, int c) {
+    return r >= s->ry && r < s->ry + s->rh
+        && c >= s->rx && c < s->rx + s->rw;
+}
+
+void term_clear(void) {
+    if (cur->rw > 0) release(cur);
+    for (int r = 0; r < cur->rows; r++)
+        for (int c = 0; c < cur->cols; c++)
+            cur->want[r][c] = (Cell){ ' ', 0 };
+    cur->x = cur->y = 0;
+    cur->attr  = ATTR_DEFAULT;
+    cur->dirty = true;
+}
+
+int term_width(void) {
+    return cur->cols;
+}
+
+int term_row(void) {
+    return cur->y;
+}
+
+void term_goto(int x, int y) {
+    cur->x = x < 0 ? 0 : x >= cur->cols ? cur->cols - 1 : x;
+    cur->y = y < 0 ? 0 : y >= cur->rows ? cur->rows - 1 : y;
+}
+
+// ── Scrittura celle ───────────────────────────────────────────────────────
+// Stesso comportamento della console: a capo automatico a fine riga e
+// scorrimento verso l'alto oltre l'ultima.
+static void new_row(TermScreen *s) {
+    s->x = 0;
+    if (++s->y < s->rows) return;
+    memmove(s->want[0], s->want[1],
+            sizeof(s->want[0]) * (s->rows - 1));
+    for (int c = 0; c < s->cols; c++)
+        s->want[s->rows - 1][c] = (Cell){ ' ', 0 };
+    s->y = s->rows - 1;
+}
+
+static void put_char(TermScreen *s, char ch) {
+    if (ch == '\n') { new_row(s); return; }
+    if (ch == '\r') { s->x = 0; return; }
+    if (s->x >= s->cols) new_row(s);
+    // Gli spazi hanno lo stesso aspetto con ogni colore
+    s->want[s->y][s->x++] = (Cell){ (u8)ch, ch == ' ' ? 0 : s->attr };
+}
+
+// Parametri di "\x1b[...m": 0 reset, 1 grassetto, 30-37 colore
+static void sgr(TermScreen *s, int n) {
+    if      (n == 0)             s->attr = ATTR_DEFAULT;
+    else if (n == 1)             s->attr |= ATTR_BOLD;
+    else if (n >= 30 && n <= 37) s->attr = (s->attr & ATTR_BOLD) | (n - 30);
+}
+
+void term_printf(const char *fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    TermScreen *s = cur;
+    for (const char *p = buf; *p; p++) {
+        if (p[0] == '\x1b' && p[1] == '[') {
+            int n = 0;
+            for (p += 2; *p; p++) {
+                if (*p >= '0' && *p <= '9') { n = n * 10 + (*p - '0'); continue; }
+                if (*p == ';') { sgr(s, n); n = 0; continue; }
+                if (*p == 'm') sgr(s, n);
+                break;
+            }
+            if (!*p) break;
+            continue;
+        }
+        put_char(s, *p);
+    }
+    s->dirty = true;
+}
+
+// Barra di len celle alla posizione corrente: fill '#' nel colore dato
+// (RC_* di render.h), il resto '-' in bianco
+void term_bar(int len, int fill, int color) {
+    TermScreen *s = cur;
+    for (int i = 0; i < len; i++) {
+        if (s->x >= s->cols) new_row(s);
+        s->want[s->y][s->x++] = (i < fill) ? (Cell){ '#', (u8)color }
+                                           : (Cell){ '-', RC_WHITE };
+    }
+    s->dirty = true;
+}
+
+// ── Flush ─────────────────────────────────────────────────────────────────
+// Le sequenze di celle cambiate vanno direttamente nel framebuffer;
+// la console di libctru serve solo per il font e la pulizia iniziale.
+static bool flush_screen(TermScreen *s) {
+    char run[TERM_MAX_COLS];
+    bool drawn = false;
+
+    render_target((u16*)gfxGetFramebuffer(s->gfx, GFX_LEFT, NULL, NULL),
+                  s->cols, s->rows);
+    for (int r = 0; r < s->rows; r++) {
+        if (memcmp(s->want[r], s->shown[r], sizeof(Cell) * s->cols) == 0)
+            continue;
+        int c = 0;
+        while (c < s->cols) {
+            Cell *w = &s->want[r][c], *o = &s->shown[r][c];
+            if ((w->ch == o->ch && w->attr == o->attr) || reserved(s, r, c))
+                { c++; continue; }
+
+            // Sequenza di celle cambiate con lo stesso attributo
+            u8  attr  = w->attr;
+            int start = c;
+            int n     = 0;
+            while (c < s->cols) {
+                w = &s->want[r][c];
+                o = &s->shown[r][c];
+                if ((w->ch == o->ch && w->attr == o->attr)
+                    || w->attr != attr || reserved(s, r, c)) break;
+                run[n++] = (char)w->ch;
+                *o = *w;
+                c++;
+            }
+            render_text(start, r, run, n, attr);
+            drawn = true;
+        }
+    }
+    s->dirty = false;
+    return drawn;
+}
+
+// Righe da mostrare sopra un disegno di altri: tutte le celle, anche
+// quelle riservate, vanno subito nel framebuffer. Nelle riservate il
+// contenuto resta sconosciuto, come dopo release().
+void term_paint(int y, int h) {
+    char run[TERM_MAX_COLS];
+    render_target((u16*)gfxGetFramebuffer(cur->gfx, GFX_LEFT, NULL, NULL),
+                  cur->cols, cur->rows);
+    for (int r = y; r < y + h && r < cur->rows; r++) {
+        int c = 0;
+        while (c < cur->cols) {
+            u8  attr  = cur->want[r][c].attr;
+            int start = c;
+            int n     = 0;
+            while (c < cur->cols && cur->want[r][c].attr == attr) {
+                run[n++] = (char)cur->want[r][c].ch;
+                if (!reserved(cur, r, c)) cur->shown[r][c] = cur->want[r][c];
+                c++;
+            }
+            render_text(start, r, run, n, attr);
+        }
+    }
+}
+
+bool term_reserved(int x, int y) {
+    return reserved(cur, y, x);
+}
+
+// Si misurano solo i flush che hanno disegnato qualcosa
+bool term_flush(void) {
+    u64  t0    = prof_now();
+    bool drawn = false;
+    for (int i = 0; i < 2; i++)
+        if (screens[i].dirty) drawn |= flush_screen(&screens[i]);
+    if (drawn) prof_end(PROF_TEXT, t0);
+    return drawn;
+}
@@ -0,0 +1,32 @@
+#ifndef TERM_H
+#define TERM_H
+
+#include "platform.h"
+
+// Modello a celle (carattere + attributo) di ciascuno schermo console.
+// Le funzioni draw_* scrivono qui con term_printf(), che interpreta gli
+// stessi escape ANSI di colore della console; term_flush() disegna nel
+// framebuffer (render.c) solo le celle cambiate dall'ultimo flush.
+
+#define TERM_MAX_COLS  50
+#define TERM_MAX_ROWS  30
+
+void term_init(PrintConsole *top, PrintConsole *bot);
+void term_select(PrintConsole *con);
+void term_clear(void);
+void term_goto(int x, int y);
+int  term_width(void);
+int  term_row(void);
+void term_printf(const char *fmt, ...)
+    __attribute__((format(printf, 1, 2)));
+void term_bar(int len, int fill, int color);
+// Celle lasciate a chi disegna da se' nel framebuffer (chart.c):
+// term_flush() non le tocca fino al prossimo term_clear()
+void term_reserve(int x, int y, int w, int h);
+bool term_reserved(int x, int y);
+// Ridisegna subito le righe y..y+h-1, celle riservate comprese: per
+// scritte sopra il disegno di chi le ha riservate
+void term_paint(int y, int h);
+bool term_flush(void);
+
+#endif
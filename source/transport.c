@@ -0,0 +1,338 @@
+#include "transport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifndef __3DS__
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+// ── Controllo richiesta ───────────────────────────────────────────────────
+void fetchctl_init(FetchCtl *ctl) {
+    memset(ctl, 0, sizeof(*ctl));
+    LightLock_Init(&ctl->lock);
+}
+
+void fetchctl_cancel(FetchCtl *ctl) {
+    LightLock_Lock(&ctl->lock);
+    ctl->cancel = true;
+    if (ctl->active) {
+        ctl->active->cancelled = true;
+        ctl->active->tp->cancel(ctl->active);
+    }
+    LightLock_Unlock(&ctl->lock);
+}
+
+#ifdef __3DS__
+
+// ── httpc ─────────────────────────────────────────────────────────────────
+static int httpc_open(HttpConn *c) {
+    httpcContext *ctx = &c->u.ctx;
+    if (R_FAILED(httpcOpenContext(ctx, HTTPC_METHOD_GET, c->url, 1)))
+        return -1;
+
+    httpcSetSSLOpt(ctx, SSLCOPT_DisableVerify);
+    httpcSetKeepAlive(ctx, c->keepalive ? HTTPC_KEEPALIVE_ENABLED
+                                        : HTTPC_KEEPALIVE_DISABLED);
+    httpcAddRequestHeaderField(ctx, "User-Agent",
+                               "Mozilla/5.0 (Nintendo 3DS)");
+    httpcAddRequestHeaderField(ctx, "Accept",       "application/json");
+    httpcAddRequestHeaderField(ctx, "Accept-Encoding", "identity");
+    httpcAddRequestHeaderField(ctx, "Connection",
+                               c->keepalive ? "keep-alive" : "close");
+    return 0;
+}
+
+static int httpc_begin(HttpConn *c) {
+    httpcContext *ctx = &c->u.ctx;
+    if (R_FAILED(httpcBeginRequest(ctx))) return -2;
+
+    httpcGetResponseStatusCode(ctx, &c->status);
+
+    char connhdr[16] = "";
+    httpcGetResponseHeader(ctx, "Connection", connhdr, sizeof(connhdr));
+    if (strcasecmp(connhdr, "close") == 0) c->keepalive = false;
+
+    if (c->status == 301 || c->status == 302)
+        httpcGetResponseHeader(ctx, "Location",
+                               c->location, sizeof(c->location));
+    return 0;
+}
+
+static int httpc_receive(HttpConn *c, u8 *buf, u32 size, u32 *got) {
+    u32 readSize = 0, total = 0;
+    Result rc = httpcReceiveData(&c->u.ctx, buf, size);
+    httpcGetDownloadSizeState(&c->u.ctx, &readSize, &total);
+
+    *got = readSize > c->received ? readSize - c->received : 0;
+    c->received = readSize;
+    c->total    = total;
+
+    if (rc == (Result)HTTPC_RESULTCODE_DOWNLOADPENDING) return 1;
+    return R_FAILED(rc) ? -1 : 0;
+}
+
+static void httpc_cancel(HttpConn *c) {
+    httpcCancelConnection(&c->u.ctx);
+}
+
+static void httpc_close(HttpConn *c) {
+    httpcCloseContext(&c->u.ctx);
+}
+
+const Transport transport_httpc = {
+    "httpc", httpc_open, httpc_begin, httpc_receive,
+    httpc_cancel, httpc_close
+};
+
+static const Transport *current = &transport_httpc;
+
+#else
+
+// ── Latenza simulata ──────────────────────────────────────────────────────
+static u32 latFirst, latPerKb;
+
+void transport_latency(u32 first_ms, u32 per_kb_ms) {
+    latFirst = first_ms;
+    latPerKb = per_kb_ms;
+}
+
+// Attesa a fette di 10 ms, interrotta da un annullamento
+static bool latency_wait(HttpConn *c, u32 ms) {
+    while (ms > 0 && !c->cancelled) {
+        u32 step = ms < 10 ? ms : 10;
+        svcSleepThread((s64)step * 1000000);
+        ms -= step;
+    }
+    return !c->cancelled;
+}
+
+static bool latency_body(HttpConn *c, u32 bytes) {
+    return latency_wait(c, (u32)((u64)bytes * latPerKb / 1024));
+}
+
+// ── Risposte registrate ───────────────────────────────────────────────────
+// Un file per URL, nominato con l'hash FNV-1a dell'URL completo.
+static char fileDir[256];
+static bool fileRecord;
+
+void transport_file_dir(const char *dir, bool record) {
+    snprintf(fileDir, sizeof(fileDir), "%s", dir);
+    fileRecord = record;
+}
+
+void transport_file_name(const char *url, char *out, int maxlen) {
+    u32 h = 2166136261u;
+    for (const char *p = url; *p; p++) {
+        h ^= (u8)*p;
+        h *= 16777619u;
+    }
+    snprintf(out, maxlen, "%s/%08lx.json", fileDir, (unsigned long)h);
+}
+
+static int file_open(HttpConn *c) {
+    if (!fileDir[0]) return -1;
+    char path[300];
+    transport_file_name(c->url, path, sizeof(path));
+    c->u.rec.file = fopen(path, "rb");
+    return 0;
+}
+
+static int file_begin(HttpConn *c) {
+    if (!latency_wait(c, latFirst)) return -2;
+    FILE *f = (FILE*)c->u.rec.file;
+    if (!f) {
+        c->status = 404;
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    c->total = (u32)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    c->status = 200;
+    return 0;
+}
+
+static int file_receive(HttpConn *c, u8 *buf, u32 size, u32 *got) {
+    FILE *f = (FILE*)c->u.rec.file;
+    *got = f ? (u32)fread(buf, 1, size, f) : 0;
+    c->received += *got;
+    if (!latency_body(c, *got)) return -1;
+    return c->received < c->total ? 1 : 0;
+}
+
+static void file_cancel(HttpConn *c) {
+    (void)c;
+}
+
+static void file_close(HttpConn *c) {
+    if (c->u.rec.file) fclose((FILE*)c->u.rec.file);
+}
+
+const Transport transport_file = {
+    "file", file_open, file_begin, file_receive,
+    file_cancel, file_close
+};
+
+// ── Server HTTP in loopback ───────────────────────────────────────────────
+// Ogni richiesta va a 127.0.0.1:porta con il path originale e l'header
+// Host del server vero. La richiesta e' HTTP/1.0, quindi il server
+// risponde senza chunked encoding; una connessione per richiesta.
+static int loopPort = 8080;
+
+void transport_loopback_port(int port) {
+    loopPort = port;
+}
+
+static void url_split(const char *url, char *host, int hostlen,
+                      const char **path) {
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    int n = 0;
+    while (p[n] && p[n] != '/' && p[n] != '?' && n < hostlen - 1) {
+        host[n] = p[n];
+        n++;
+    }
+    host[n] = '\0';
+    while (p[n] && p[n] != '/' && p[n] != '?') n++;
+    *path = p[n] ? p + n : "/";
+}
+
+static int loop_open(HttpConn *c) {
+    c->u.sock.fd     = socket(AF_INET, SOCK_STREAM, 0);
+    c->u.sock.record = NULL;
+    return c->u.sock.fd < 0 ? -1 : 0;
+}
+
+// Valore di un header nella risposta, "" se assente
+static void header_value(const char *hdr, const char *name,
+                         char *out, int maxlen) {
+    int nlen = (int)strlen(name);
+    out[0] = '\0';
+    for (const char *l = strstr(hdr, "\r\n"); l; l = strstr(l, "\r\n")) {
+        l += 2;
+        if (strncasecmp(l, name, nlen) != 0 || l[nlen] != ':') continue;
+        const char *v = l + nlen + 1;
+        while (*v == ' ') v++;
+        int n = 0;
+        while (v[n] && v[n] != '\r' && n < maxlen - 1) { out[n] = v[n]; n++; }
+        out[n] = '\0';
+        return;
+    }
+}
+
+static int loop_begin(HttpConn *c) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons((u16)loopPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(c->u.sock.fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+        return -2;
+    if (!latency_wait(c, latFirst)) return -2;
+
+    char host[64], req[2304];
+    const char *path;
+    url_split(c->url, host, sizeof(host), &path);
+    int n = snprintf(req, sizeof(req),
+        "GET %s HTTP/1.0\r\n"
+        "Host: %s\r\n"
+        "User-Agent: Mozilla/5.0 (Nintendo 3DS)\r\n"
+        "Accept: application/json\r\n"
+        "Accept-Encoding: identity\r\n"
+        "\r\n", path, host);
+    if (n >= (int)sizeof(req) || send(c->u.sock.fd, req, n, 0) != n)
+        return -2;
+
+    // Header fino alla riga vuota; quello che segue e' gia' corpo
+    char *hb  = c->u.sock.hbuf;
+    u32   len = 0;
+    char *end = NULL;
+    while (!end) {
+        if (len >= sizeof(c->u.sock.hbuf) - 1) return -2;
+        ssize_t r = recv(c->u.sock.fd, hb + len,
+                         sizeof(c->u.sock.hbuf) - 1 - len, 0);
+        if (r <= 0) return -2;
+        len += (u32)r;
+        hb[len] = '\0';
+        end = strstr(hb, "\r\n\r\n");
+    }
+    *end = '\0';
+    c->u.sock.head = (u32)(end + 4 - hb);
+    c->u.sock.hlen = len;
+
+    const char *sp = strchr(hb, ' ');
+    c->status = sp ? (u32)atoi(sp + 1) : 0;
+
+    char val[32];
+    header_value(hb, "Content-Length", val, sizeof(val));
+    c->u.sock.sized = val[0] != '\0';
+    c->u.sock.left  = c->u.sock.sized ? (u32)strtoul(val, NULL, 10) : 0;
+    c->total        = c->u.sock.left;
+    c->keepalive    = false;
+    if (c->status == 301 || c->status == 302)
+        header_value(hb, "Location", c->location, sizeof(c->location));
+
+    if (fileRecord && fileDir[0] && c->status == 200) {
+        char fpath[300];
+        transport_file_name(c->url, fpath, sizeof(fpath));
+        c->u.sock.record = fopen(fpath, "wb");
+    }
+    return 0;
+}
+
+static int loop_receive(HttpConn *c, u8 *buf, u32 size, u32 *got) {
+    *got = 0;
+    if (c->u.sock.sized && c->u.sock.left == 0) return 0;
+    if (c->u.sock.sized && size > c->u.sock.left) size = c->u.sock.left;
+
+    u32 n;
+    if (c->u.sock.head < c->u.sock.hlen) {
+        n = c->u.sock.hlen - c->u.sock.head;
+        if (n > size) n = size;
+        memcpy(buf, c->u.sock.hbuf + c->u.sock.head, n);
+        c->u.sock.head += n;
+    } else {
+        ssize_t r = recv(c->u.sock.fd, buf, size, 0);
+        if (r < 0) return -1;
+        if (r == 0) return (c->u.sock.sized || c->cancelled) ? -1 : 0;
+        n = (u32)r;
+    }
+
+    if (c->u.sock.record) fwrite(buf, 1, n, (FILE*)c->u.sock.record);
+    *got = n;
+    c->received += n;
+    if (c->u.sock.sized) c->u.sock.left -= n;
+    if (!latency_body(c, n)) return -1;
+    return (c->u.sock.sized && c->u.sock.left == 0) ? 0 : 1;
+}
+
+static void loop_cancel(HttpConn *c) {
+    shutdown(c->u.sock.fd, SHUT_RDWR);
+}
+
+static void loop_close(HttpConn *c) {
+    if (c->u.sock.record) fclose((FILE*)c->u.sock.record);
+    close(c->u.sock.fd);
+}
+
+const Transport transport_loopback = {
+    "loopback", loop_open, loop_begin, loop_receive,
+    loop_cancel, loop_close
+};
+
+static const Transport *current = &transport_file;
+
+#endif
+
+// ── Selezione ─────────────────────────────────────────────────────────────
+const Transport *transport_get(void) {
+    return current;
+}
+
+void transport_set(const Transport *t) {
+    current = t;
+}
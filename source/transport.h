@@ -0,0 +1,93 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "platform.h"
+#include "weather.h"
+
+// Trasporto HTTP intercambiabile usato da http_get_stream(): sul 3DS e'
+// httpc, su un PC puo' essere una cartella di risposte registrate o un
+// server HTTP in loopback, cosi' fetch e parsing girano anche sotto un
+// profiler con latenza riproducibile.
+
+typedef struct HttpConn HttpConn;
+
+typedef struct {
+    const char *name;
+    // Prepara la richiesta verso c->url senza attendere la rete
+    int  (*open)(HttpConn *c);
+    // Invia la GET e attende gli header: status, keepalive, total e
+    // location vengono compilati. Ritorna 0 oppure un errore < 0.
+    int  (*begin)(HttpConn *c);
+    // Legge fino a size byte in buf. Ritorna 1 se ci sono altri dati,
+    // 0 a fine corpo, < 0 in caso di errore.
+    int  (*receive)(HttpConn *c, u8 *buf, u32 size, u32 *got);
+    // Sblocca begin/receive da un altro thread
+    void (*cancel)(HttpConn *c);
+    // Solo dopo un open riuscito
+    void (*close)(HttpConn *c);
+} Transport;
+
+struct HttpConn {
+    const Transport *tp;
+    const char      *url;
+    bool             keepalive;   // in: richiesto; out: il server lo consente
+    volatile bool    cancelled;
+    u32              status;
+    u32              received;
+    u32              total;       // 0 se la lunghezza non e' nota
+    char             location[512];
+    union {
+#ifdef __3DS__
+        httpcContext ctx;
+#else
+        struct {
+            void *file;
+        } rec;
+        struct {
+            int   fd;
+            void *record;
+            bool  sized;
+            u32   left;
+            u32   head;
+            u32   hlen;
+            char  hbuf[1024];
+        } sock;
+#endif
+    } u;
+};
+
+#ifdef __3DS__
+extern const Transport transport_httpc;
+#else
+extern const Transport transport_file;
+extern const Transport transport_loopback;
+
+// Risposte registrate: un file per URL in dir, nominato con
+// transport_file_name(). Con record attivo il loopback salva li' ogni
+// corpo ricevuto con status 200.
+void transport_file_dir(const char *dir, bool record);
+void transport_file_name(const char *url, char *out, int maxlen);
+// Porta del server HTTP locale a cui il loopback invia ogni richiesta
+void transport_loopback_port(int port);
+// Ritardo prima degli header e per ogni KB di corpo (trasporti host)
+void transport_latency(u32 first_ms, u32 per_kb_ms);
+#endif
+
+const Transport *transport_get(void);
+void             transport_set(const Transport *t);
+
+// Stato condiviso fra chi scarica e chi aspetta: byte ricevuti per la
+// barra di avanzamento e annullamento della richiesta in corso (anche
+// durante DNS e connessione, tramite Transport.cancel).
+struct FetchCtl {
+    LightLock      lock;
+    HttpConn      *active;
+    volatile bool  cancel;
+    volatile u32   received;
+    volatile u32   total;
+};
+
+void fetchctl_init(FetchCtl *ctl);
+void fetchctl_cancel(FetchCtl *ctl);
+
+#endif
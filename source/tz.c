@@ -0,0 +1,325 @@
+#include "tz.h"
+#include <stdio.h>
+#include <string.h>
+
+// ── Tabella ───────────────────────────────────────────────────────────────
+// In ordine di strcmp() per la ricerca binaria
+static const TzZone zones[] = {
+    { "Africa/Abidjan",                      0, TZ_RULE_NONE },
+    { "Africa/Accra",                        0, TZ_RULE_NONE },
+    { "Africa/Addis_Ababa",                180, TZ_RULE_NONE },
+    { "Africa/Algiers",                     60, TZ_RULE_NONE },
+    { "Africa/Cairo",                      120, TZ_RULE_EG   },
+    { "Africa/Dakar",                        0, TZ_RULE_NONE },
+    { "Africa/Dar_es_Salaam",              180, TZ_RULE_NONE },
+    { "Africa/Johannesburg",               120, TZ_RULE_NONE },
+    { "Africa/Khartoum",                   120, TZ_RULE_NONE },
+    { "Africa/Kinshasa",                    60, TZ_RULE_NONE },
+    { "Africa/Lagos",                       60, TZ_RULE_NONE },
+    { "Africa/Luanda",                      60, TZ_RULE_NONE },
+    { "Africa/Maputo",                     120, TZ_RULE_NONE },
+    { "Africa/Nairobi",                    180, TZ_RULE_NONE },
+    { "Africa/Tripoli",                    120, TZ_RULE_NONE },
+    { "Africa/Tunis",                       60, TZ_RULE_NONE },
+    { "America/Anchorage",                -540, TZ_RULE_US   },
+    { "America/Argentina/Buenos_Aires",   -180, TZ_RULE_NONE },
+    { "America/Asuncion",                 -180, TZ_RULE_NONE },
+    { "America/Bogota",                   -300, TZ_RULE_NONE },
+    { "America/Cancun",                   -300, TZ_RULE_NONE },
+    { "America/Caracas",                  -240, TZ_RULE_NONE },
+    { "America/Chicago",                  -360, TZ_RULE_US   },
+    { "America/Costa_Rica",               -360, TZ_RULE_NONE },
+    { "America/Denver",                   -420, TZ_RULE_US   },
+    { "America/Detroit",                  -300, TZ_RULE_US   },
+    { "America/Edmonton",                 -420, TZ_RULE_US   },
+    { "America/El_Salvador",              -360, TZ_RULE_NONE },
+    { "America/Guatemala",                -360, TZ_RULE_NONE },
+    { "America/Guayaquil",                -300, TZ_RULE_NONE },
+    { "America/Halifax",                  -240, TZ_RULE_US   },
+    { "America/Indiana/Indianapolis",     -300, TZ_RULE_US   },
+    { "America/La_Paz",                   -240, TZ_RULE_NONE },
+    { "America/Lima",                     -300, TZ_RULE_NONE },
+    { "America/Los_Angeles",              -480, TZ_RULE_US   },
+    { "America/Managua",                  -360, TZ_RULE_NONE },
+    { "America/Mexico_City",              -360, TZ_RULE_NONE },
+    { "America/Monterrey",                -360, TZ_RULE_NONE },
+    { "America/Montevideo",               -180, TZ_RULE_NONE },
+    { "America/New_York",                 -300, TZ_RULE_US   },
+    { "America/Panama",                   -300, TZ_RULE_NONE },
+    { "America/Phoenix",                  -420, TZ_RULE_NONE },
+    { "America/Puerto_Rico",              -240, TZ_RULE_NONE },
+    { "America/Regina",                   -360, TZ_RULE_NONE },
+    { "America/Santiago",                 -240, TZ_RULE_CL   },
+    { "America/Santo_Domingo",            -240, TZ_RULE_NONE },
+    { "America/Sao_Paulo",                -180, TZ_RULE_NONE },
+    { "America/St_Johns",                 -210, TZ_RULE_US   },
+    { "America/Tegucigalpa",              -360, TZ_RULE_NONE },
+    { "America/Tijuana",                  -480, TZ_RULE_US   },
+    { "America/Toronto",                  -300, TZ_RULE_US   },
+    { "America/Vancouver",                -480, TZ_RULE_US   },
+    { "America/Winnipeg",                 -360, TZ_RULE_US   },
+    { "Asia/Almaty",                       300, TZ_RULE_NONE },
+    { "Asia/Amman",                        180, TZ_RULE_NONE },
+    { "Asia/Baghdad",                      180, TZ_RULE_NONE },
+    { "Asia/Baku",                         240, TZ_RULE_NONE },
+    { "Asia/Bangkok",                      420, TZ_RULE_NONE },
+    { "Asia/Colombo",                      330, TZ_RULE_NONE },
+    { "Asia/Damascus",                     180, TZ_RULE_NONE },
+    { "Asia/Dhaka",                        360, TZ_RULE_NONE },
+    { "Asia/Dubai",                        240, TZ_RULE_NONE },
+    { "Asia/Ho_Chi_Minh",                  420, TZ_RULE_NONE },
+    { "Asia/Hong_Kong",                    480, TZ_RULE_NONE },
+    { "Asia/Jakarta",                      420, TZ_RULE_NONE },
+    { "Asia/Jerusalem",                    120, TZ_RULE_IL   },
+    { "Asia/Kabul",                        270, TZ_RULE_NONE },
+    { "Asia/Karachi",                      300, TZ_RULE_NONE },
+    { "Asia/Kathmandu",                    345, TZ_RULE_NONE },
+    { "Asia/Kolkata",                      330, TZ_RULE_NONE },
+    { "Asia/Kuala_Lumpur",                 480, TZ_RULE_NONE },
+    { "Asia/Kuwait",                       180, TZ_RULE_NONE },
+    { "Asia/Makassar",                     480, TZ_RULE_NONE },
+    { "Asia/Manila",                       480, TZ_RULE_NONE },
+    { "Asia/Muscat",                       240, TZ_RULE_NONE },
+    { "Asia/Novosibirsk",                  420, TZ_RULE_NONE },
+    { "Asia/Phnom_Penh",                   420, TZ_RULE_NONE },
+    { "Asia/Qatar",                        180, TZ_RULE_NONE },
+    { "Asia/Riyadh",                       180, TZ_RULE_NONE },
+    { "Asia/Seoul",                        540, TZ_RULE_NONE },
+    { "Asia/Shanghai",                     480, TZ_RULE_NONE },
+    { "Asia/Singapore",                    480, TZ_RULE_NONE },
+    { "Asia/Taipei",                       480, TZ_RULE_NONE },
+    { "Asia/Tashkent",                     300, TZ_RULE_NONE },
+    { "Asia/Tbilisi",                      240, TZ_RULE_NONE },
+    { "Asia/Tehran",                       210, TZ_RULE_NONE },
+    { "Asia/Tokyo",                        540, TZ_RULE_NONE },
+    { "Asia/Ulaanbaatar",                  480, TZ_RULE_NONE },
+    { "Asia/Vladivostok",                  600, TZ_RULE_NONE },
+    { "Asia/Yangon",                       390, TZ_RULE_NONE },
+    { "Asia/Yekaterinburg",                300, TZ_RULE_NONE },
+    { "Asia/Yerevan",                      240, TZ_RULE_NONE },
+    { "Atlantic/Azores",                   -60, TZ_RULE_EU   },
+    { "Atlantic/Canary",                     0, TZ_RULE_EU   },
+    { "Atlantic/Madeira",                    0, TZ_RULE_EU   },
+    { "Atlantic/Reykjavik",                  0, TZ_RULE_NONE },
+    { "Australia/Adelaide",                570, TZ_RULE_AU   },
+    { "Australia/Brisbane",                600, TZ_RULE_NONE },
+    { "Australia/Darwin",                  570, TZ_RULE_NONE },
+    { "Australia/Hobart",                  600, TZ_RULE_AU   },
+    { "Australia/Melbourne",               600, TZ_RULE_AU   },
+    { "Australia/Perth",                   480, TZ_RULE_NONE },
+    { "Australia/Sydney",                  600, TZ_RULE_AU   },
+    { "Etc/UTC",                             0, TZ_RULE_NONE },
+    { "Europe/Amsterdam",                   60, TZ_RULE_EU   },
+    { "Europe/Andorra",                     60, TZ_RULE_EU   },
+    { "Europe/Athens",                     120, TZ_RULE_EU   },
+    { "Europe/Belgrade",                    60, TZ_RULE_EU   },
+    { "Europe/Berlin",                      60, TZ_RULE_EU   },
+    { "Europe/Bratislava",                  60, TZ_RULE_EU   },
+    { "Europe/Brussels",                    60, TZ_RULE_EU   },
+    { "Europe/Bucharest",                  120, TZ_RULE_EU   },
+    { "Europe/Budapest",                    60, TZ_RULE_EU   },
+    { "Europe/Chisinau",                   120, TZ_RULE_EU   },
+    { "Europe/Copenhagen",                  60, TZ_RULE_EU   },
+    { "Europe/Dublin",                       0, TZ_RULE_EU   },
+    { "Europe/Gibraltar",                   60, TZ_RULE_EU   },
+    { "Europe/Guernsey",                     0, TZ_RULE_EU   },
+    { "Europe/Helsinki",                   120, TZ_RULE_EU   },
+    { "Europe/Isle_of_Man",                  0, TZ_RULE_EU   },
+    { "Europe/Istanbul",                   180, TZ_RULE_NONE },
+    { "Europe/Jersey",                       0, TZ_RULE_EU   },
+    { "Europe/Kaliningrad",                120, TZ_RULE_NONE },
+    { "Europe/Kiev",                       120, TZ_RULE_EU   },
+    { "Europe/Kyiv",                       120, TZ_RULE_EU   },
+    { "Europe/Lisbon",                       0, TZ_RULE_EU   },
+    { "Europe/Ljubljana",                   60, TZ_RULE_EU   },
+    { "Europe/London",                       0, TZ_RULE_EU   },
+    { "Europe/Luxembourg",                  60, TZ_RULE_EU   },
+    { "Europe/Madrid",                      60, TZ_RULE_EU   },
+    { "Europe/Malta",                       60, TZ_RULE_EU   },
+    { "Europe/Minsk",                      180, TZ_RULE_NONE },
+    { "Europe/Monaco",                      60, TZ_RULE_EU   },
+    { "Europe/Moscow",                     180, TZ_RULE_NONE },
+    { "Europe/Oslo",                        60, TZ_RULE_EU   },
+    { "Europe/Paris",                       60, TZ_RULE_EU   },
+    { "Europe/Podgorica",                   60, TZ_RULE_EU   },
+    { "Europe/Prague",                      60, TZ_RULE_EU   },
+    { "Europe/Riga",                       120, TZ_RULE_EU   },
+    { "Europe/Rome",                        60, TZ_RULE_EU   },
+    { "Europe/Samara",                     240, TZ_RULE_NONE },
+    { "Europe/San_Marino",                  60, TZ_RULE_EU   },
+    { "Europe/Sarajevo",                    60, TZ_RULE_EU   },
+    { "Europe/Skopje",                      60, TZ_RULE_EU   },
+    { "Europe/Sofia",                      120, TZ_RULE_EU   },
+    { "Europe/Stockholm",                   60, TZ_RULE_EU   },
+    { "Europe/Tallinn",                    120, TZ_RULE_EU   },
+    { "Europe/Tirane",                      60, TZ_RULE_EU   },
+    { "Europe/Vaduz",                       60, TZ_RULE_EU   },
+    { "Europe/Vatican",                     60, TZ_RULE_EU   },
+    { "Europe/Vienna",                      60, TZ_RULE_EU   },
+    { "Europe/Vilnius",                    120, TZ_RULE_EU   },
+    { "Europe/Volgograd",                  180, TZ_RULE_NONE },
+    { "Europe/Warsaw",                      60, TZ_RULE_EU   },
+    { "Europe/Zagreb",                      60, TZ_RULE_EU   },
+    { "Europe/Zurich",                      60, TZ_RULE_EU   },
+    { "GMT",                                 0, TZ_RULE_NONE },
+    { "Indian/Maldives",                   300, TZ_RULE_NONE },
+    { "Indian/Mauritius",                  240, TZ_RULE_NONE },
+    { "Indian/Reunion",                    240, TZ_RULE_NONE },
+    { "Pacific/Auckland",                  720, TZ_RULE_NZ   },
+    { "Pacific/Fiji",                      720, TZ_RULE_NONE },
+    { "Pacific/Guam",                      600, TZ_RULE_NONE },
+    { "Pacific/Honolulu",                 -600, TZ_RULE_NONE },
+    { "Pacific/Noumea",                    660, TZ_RULE_NONE },
+    { "Pacific/Port_Moresby",              600, TZ_RULE_NONE },
+    { "Pacific/Tongatapu",                 780, TZ_RULE_NONE },
+    { "UTC",                                 0, TZ_RULE_NONE },
+};
+
+#define ZONE_COUNT  (int)(sizeof(zones) / sizeof(zones[0]))
+
+const TzZone *tz_find(const char *name) {
+    int lo = 0, hi = ZONE_COUNT - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c   = strcmp(name, zones[mid].name);
+        if (c == 0) return &zones[mid];
+        if (c < 0) hi = mid - 1;
+        else       lo = mid + 1;
+    }
+    return NULL;
+}
+
+// ── Calendario ────────────────────────────────────────────────────────────
+// Giorni dal 1970-01-01 (calendario gregoriano prolettico)
+static s32 days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(s32 z, int *y, int *m, int *d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp  = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp + (mp < 10 ? 3 : -9);
+    *y = yoe + era * 400 + (*m <= 2);
+}
+
+static s32 floor_div(s64 a, s32 b) {
+    return (s32)(a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+
+// 0 = domenica; il 1970-01-01 era un giovedi'
+static int weekday(s32 days) {
+    return (int)(((days % 7) + 11) % 7);
+}
+
+// n-esimo giorno wd del mese (n >= 1), o l'ultimo con n = 0
+static s32 nth_wday(int y, int m, int wd, int n) {
+    if (n > 0) {
+        s32 first = days_from_civil(y, m, 1);
+        return first + (wd - weekday(first) + 7) % 7 + 7 * (n - 1);
+    }
+    s32 last = days_from_civil(m == 12 ? y + 1 : y, m == 12 ? 1 : m + 1, 1) - 1;
+    return last - (weekday(last) - wd + 7) % 7;
+}
+
+#define SUN  0
+#define THU  4
+#define FRI  5
+#define SAT  6
+#define H    3600
+
+// ── Ora legale ────────────────────────────────────────────────────────────
+// Inizio e fine dell'ora legale nell'anno y, in secondi UTC. std e'
+// l'offset solare in secondi: le regole che cambiano a un'ora locale lo
+// sottraggono (e sottraggono anche l'ora legale alla fine).
+static void dst_bounds(int rule, int y, s32 std, s64 *start, s64 *end) {
+    const s64 D = 86400;
+    switch (rule) {
+    case TZ_RULE_EU:
+        *start = nth_wday(y, 3, SUN, 0) * D + 1 * H;
+        *end   = nth_wday(y, 10, SUN, 0) * D + 1 * H;
+        break;
+    case TZ_RULE_US:
+        *start = nth_wday(y, 3, SUN, 2) * D + 2 * H - std;
+        *end   = nth_wday(y, 11, SUN, 1) * D + 2 * H - std - H;
+        break;
+    case TZ_RULE_AU:
+        *start = nth_wday(y, 10, SUN, 1) * D + 2 * H - std;
+        *end   = nth_wday(y, 4, SUN, 1) * D + 3 * H - std - H;
+        break;
+    case TZ_RULE_NZ:
+        *start = nth_wday(y, 9, SUN, 0) * D + 2 * H - std;
+        *end   = nth_wday(y, 4, SUN, 1) * D + 3 * H - std - H;
+        break;
+    case TZ_RULE_CL:
+        *start = (nth_wday(y, 9, SAT, 1) + 1) * D + 4 * H;
+        *end   = (nth_wday(y, 4, SAT, 1) + 1) * D + 3 * H;
+        break;
+    case TZ_RULE_IL:
+        *start = (nth_wday(y, 3, SUN, 0) - 2) * D + 2 * H - std;
+        *end   = nth_wday(y, 10, SUN, 0) * D + 2 * H - std - H;
+        break;
+    case TZ_RULE_EG:
+        *start = nth_wday(y, 4, FRI, 0) * D - std;
+        *end   = (nth_wday(y, 10, THU, 0) + 1) * D - std - H;
+        break;
+    default:
+        *start = *end = 0;
+        break;
+    }
+}
+
+s32 tz_offset(const TzZone *z, s64 utc) {
+    s32 std = z->std * 60;
+    if (z->rule == TZ_RULE_NONE) return std;
+
+    int y, m, d;
+    civil_from_days(floor_div(utc + std, 86400), &y, &m, &d);
+    s64 start, end;
+    dst_bounds(z->rule, y, std, &start, &end);
+
+    // Emisfero sud: l'ora legale scavalca il capodanno
+    bool dst = start < end ? (utc >= start && utc < end)
+                           : (utc >= start || utc < end);
+    return dst ? std + H : std;
+}
+
+// ── Date ISO ──────────────────────────────────────────────────────────────
+static int digits(const char *s, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        v = v * 10 + (s[i] - '0');
+    }
+    return v;
+}
+
+bool tz_parse_iso(const char *s, int len, s64 *out) {
+    if (len < 16 || s[4] != '-' || s[7] != '-' || s[10] != 'T'
+        || s[13] != ':')
+        return false;
+    int y = digits(s, 4), mo = digits(s + 5, 2), d = digits(s + 8, 2);
+    int h = digits(s + 11, 2), mi = digits(s + 14, 2);
+    if (y < 0 || mo < 1 || mo > 12 || d < 1 || h < 0 || mi < 0)
+        return false;
+    *out = (s64)days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60;
+    return true;
+}
+
+void tz_format_iso(s64 t, char *out, int maxlen) {
+    s32 days = floor_div(t, 86400);
+    s32 sec  = (s32)(t - (s64)days * 86400);
+    int y, m, d;
+    civil_from_days(days, &y, &m, &d);
+    snprintf(out, maxlen, "%04d-%02d-%02dT%02d:%02d",
+             y, m, d, (int)(sec / 3600), (int)(sec / 60 % 60));
+}
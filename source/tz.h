@@ -0,0 +1,35 @@
+#ifndef TZ_H
+#define TZ_H
+
+#include "platform.h"
+
+// Fusi orari IANA piu' comuni con la loro regola dell'ora legale, per
+// portare in ora locale le risposte chieste in GMT. I fusi che non sono
+// in tabella si chiedono a Open-Meteo per nome come prima.
+
+typedef struct {
+    const char *name;
+    s16         std;    // minuti a est di UTC, ora solare
+    u8          rule;   // TZ_RULE_*
+} TzZone;
+
+enum {
+    TZ_RULE_NONE = 0,
+    TZ_RULE_EU,         // ultima domenica di marzo e di ottobre, 01:00 UTC
+    TZ_RULE_US,         // seconda domenica di marzo, prima di novembre
+    TZ_RULE_AU,         // prima domenica di ottobre, prima di aprile
+    TZ_RULE_NZ,         // ultima domenica di settembre, prima di aprile
+    TZ_RULE_CL,         // dopo il primo sabato di settembre e di aprile
+    TZ_RULE_IL,         // venerdi' prima dell'ultima domenica di marzo
+    TZ_RULE_EG          // ultimo venerdi' di aprile, ultimo giovedi' di ottobre
+};
+
+const TzZone *tz_find(const char *name);
+// Secondi a est di UTC nell'istante utc (secondi dal 1970)
+s32  tz_offset(const TzZone *z, s64 utc);
+
+// "YYYY-MM-DDTHH:MM" <-> secondi dal 1970, senza fuso
+bool tz_parse_iso(const char *s, int len, s64 *out);
+void tz_format_iso(s64 t, char *out, int maxlen);
+
+#endif
@@ -0,0 +1,62 @@
+#include "vlist.h"
+#include "term.h"
+#include "ansi.h"
+
+void vlist_init(VList *l, int rows, int row_h) {
+    l->count = 0;
+    l->top   = 0;
+    l->rows  = rows;
+    l->row_h = row_h;
+}
+
+static int max_top(const VList *l) {
+    int m = l->count - l->rows;
+    return m > 0 ? m : 0;
+}
+
+void vlist_set_count(VList *l, int count) {
+    l->count = count < 0 ? 0 : count;
+    if (l->top > max_top(l)) l->top = max_top(l);
+}
+
+void vlist_show(VList *l, int index) {
+    if (index < l->top)                 l->top = index;
+    else if (index >= l->top + l->rows) l->top = index - l->rows + 1;
+    if (l->top > max_top(l)) l->top = max_top(l);
+    if (l->top < 0)          l->top = 0;
+}
+
+bool vlist_scroll(VList *l, int delta) {
+    int top = l->top + delta;
+    if (top > max_top(l)) top = max_top(l);
+    if (top < 0)          top = 0;
+    if (top == l->top) return false;
+    l->top = top;
+    return true;
+}
+
+void vlist_draw(const VList *l, int sel, VListRow row, void *user) {
+    int y     = term_row();
+    int shown = l->count - l->top;
+    if (shown > l->rows) shown = l->rows;
+    if (shown < 0)       shown = 0;
+
+    for (int k = 0; k < shown; k++) {
+        int i = l->top + k;
+        term_goto(0, y + k * l->row_h);
+        row(user, i, i == sel);
+    }
+
+    // Altri elementi sopra o sotto la finestra
+    int edge = term_width() - 1;
+    if (l->top > 0) {
+        term_goto(edge, y);
+        term_printf(C_CYN "^" C_RST);
+    }
+    if (l->top + shown < l->count) {
+        term_goto(edge, y + (shown - 1) * l->row_h);
+        term_printf(C_CYN "v" C_RST);
+    }
+
+    term_goto(0, y + shown * l->row_h);
+}
@@ -0,0 +1,32 @@
+#ifndef VLIST_H
+#define VLIST_H
+
+#include <stdbool.h>
+
+// Lista virtuale: di un elenco di count elementi si disegnano solo i
+// rows visibili a partire da top, quindi il costo non dipende dalla
+// lunghezza. Ogni elemento occupa row_h righe di testo a partire dalla
+// posizione corrente del terminale; il modello a celle di term.c
+// riporta sullo schermo solo le righe che uno scorrimento ha davvero
+// cambiato.
+
+typedef void (*VListRow)(void *user, int index, bool selected);
+
+typedef struct {
+    int count;
+    int top;
+    int rows;
+    int row_h;
+} VList;
+
+void vlist_init(VList *l, int rows, int row_h);
+void vlist_set_count(VList *l, int count);
+// Sposta la finestra del minimo necessario per mostrare index
+void vlist_show(VList *l, int index);
+// Sposta la finestra di delta elementi; false se era gia' al limite
+bool vlist_scroll(VList *l, int delta);
+// Disegna gli elementi visibili (sel = -1 per nessuna selezione) e i
+// segni di scorrimento sul bordo destro, poi porta il cursore sotto
+void vlist_draw(const VList *l, int sel, VListRow row, void *user);
+
+#endif
@@ -1,8 +1,21 @@
 #ifndef WEATHER_H
 #define WEATHER_H
 
+#include <time.h>
+#include "cities.h"
+
 #define FORECAST_DAYS  7
-#define HOURLY_COUNT   24
+// Serie oraria completa: 24 ore per ogni giorno della previsione
+#define HOURLY_COUNT   (FORECAST_DAYS * 24)
+
+// Blocchi di WeatherData, scaricabili anche separatamente: ogni
+// schermata chiede solo quelli che mostra. La corrente arriva sempre
+// insieme agli altri, perche' serve per l'ora locale delle serie.
+#define WEATHER_CURRENT  0x01
+#define WEATHER_HOURLY   0x02
+#define WEATHER_DAILY    0x04
+#define WEATHER_ALL      (WEATHER_CURRENT | WEATHER_HOURLY | WEATHER_DAILY)
+#define WEATHER_BLOCKS   3
 
 typedef struct {
     float temp_now;
@@ -13,11 +26,13 @@ typedef struct {
     float feels_like_now;
     int   weather_code_now;
     int   current_hour;
+    char  current_date[12];  // data locale di current.time
 
     float hourly_temp[HOURLY_COUNT];
     float hourly_precip[HOURLY_COUNT];
     float hourly_humidity[HOURLY_COUNT];
     int   hourly_code[HOURLY_COUNT];
+    int   hourly_count;      // ore ricevute (<= HOURLY_COUNT)
 
     char  daily_date[FORECAST_DAYS][12];
     float daily_max[FORECAST_DAYS];
@@ -25,15 +40,89 @@ typedef struct {
     float daily_precip[FORECAST_DAYS];
     float daily_wind_max[FORECAST_DAYS];
     int   daily_code[FORECAST_DAYS];
+    // Sole calcolato con sun.c (weather_sun): minuti dalla mezzanotte
+    // locale, -1 nei giorni senza alba o tramonto
+    short daily_sunrise[FORECAST_DAYS];
+    short daily_sunset[FORECAST_DAYS];
+    short daily_light[FORECAST_DAYS];   // durata del giorno in minuti
 
     float uv_index;
-    int   sunrise_hour, sunrise_min;
+    int   utc_offset;        // secondi a est di UTC in current.time
+    int   sunrise_hour, sunrise_min;    // di oggi, -1 se non sorge
     int   sunset_hour,  sunset_min;
-    int   valid;
+
+    unsigned blocks;                  // WEATHER_* presenti
+    time_t   fetched[WEATHER_BLOCKS]; // download di ciascuno, 0 se manca
+    int      valid;                   // almeno un blocco
 } WeatherData;
 
+// Annullamento e avanzamento del download (vedi transport.h)
+typedef struct FetchCtl FetchCtl;
+
+#define WEATHER_CANCELLED  (-20)
+// Nessun contesto libero o arena troppo piccola per la richiesta
+#define WEATHER_NOMEM      (-21)
+// Risposta JSON incompleta o non valida, anche con lo spazio massimo
+#define WEATHER_BADJSON    (-22)
+
+// Statistiche delle connessioni HTTP. keepalive conta le richieste
+// partite quando la risposta precedente allo stesso host non aveva chiuso
+// la connessione: il riuso vero lo decide il sysmodule, e si vede solo dal
+// confronto tra i tempi fino alle intestazioni (connect_ms per le
+// connessioni nuove, keepalive_ms per le altre, in totale).
+typedef struct {
+    unsigned requests;
+    unsigned connects;
+    unsigned keepalive;
+    unsigned retries;
+    unsigned connect_ms;
+    unsigned keepalive_ms;
+} NetStats;
+
+// Memoria di lavoro dei download: un'arena per contesto, presa una volta
+// in weather_init() e azzerata a ogni richiesta. peak e last sono i byte
+// usati al massimo da una richiesta e dall'ultima.
+typedef struct {
+    unsigned contexts;
+    unsigned size;
+    unsigned requests;
+    unsigned peak;
+    unsigned last;
+    unsigned fails;
+} MemStats;
+
+void        weather_init(void);
+void        weather_exit(void);
+void        weather_net_stats(NetStats *out);
+void        weather_mem_stats(MemStats *out);
+
 int         weather_fetch(float lat, float lon,
                           const char *timezone, WeatherData *out);
+int         weather_fetch_ctl(float lat, float lon, const char *timezone,
+                              WeatherData *out, FetchCtl *ctl);
+// Previsioni di n citta' in out[0..n-1], con una richiesta per quante
+// citta' stanno in un URL. out si azzera all'inizio e solo le citta'
+// scaricate hanno valid = 1: e' l'unico segno di riuscita per ciascuna,
+// anche quando la chiamata esce prima (WEATHER_NOMEM, WEATHER_CANCELLED)
+// o un gruppo fallisce. Ritorna 0 se lo sono tutte, altrimenti l'ultimo
+// errore.
+int         weather_fetch_many(const City *list, int n, WeatherData *out);
+int         weather_fetch_many_ctl(const City *list, int n,
+                                   WeatherData *out, FetchCtl *ctl);
+// Gli stessi blocchi (WEATHER_*) per tutte le n citta'
+int         weather_fetch_many_blocks(const City *list, int n,
+                                      unsigned blocks, WeatherData *out,
+                                      FetchCtl *ctl);
+// Solo i blocchi in blocks (WEATHER_*) della citta' c, in out azzerato
+int         weather_fetch_blocks(const City *c, unsigned blocks,
+                                 WeatherData *out, FetchCtl *ctl);
+// Copia in dst i blocchi presenti in src (stessa citta')
+void        weather_merge(WeatherData *dst, const WeatherData *src);
+// Secondi dal download del blocco (WEATHER_*), -1 se manca
+long        weather_age(const WeatherData *w, unsigned block, time_t now);
+// Alba, tramonto e durata dei giorni di daily_date per la citta' c,
+// senza rete: li ricalcola anche chi legge i dati dalla cache
+void        weather_sun(const City *c, WeatherData *w);
 int         weather_geocode(const char *city_name, float *lat, float *lon,
                             char *found_name, char *timezone);
 const char *weather_code_desc(int code);
@@ -1,13 +1,28 @@
 #include "weather.h"
 #include "jsmn.h"
-#include <3ds.h>
+#include "wxparse.h"
+#include "transport.h"
+#include "prof.h"
+#include "arena.h"
+#include "tz.h"
+#include "sun.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <math.h>
 
-#define HTTP_BUF_SIZE  (96 * 1024)
-#define MAX_TOKENS     2048
+// ── Dimensioni per endpoint ───────────────────────────────────────────────
+// Le previsioni passano in streaming all'estrattore e usano solo lo
+// spazio fisso di lavoro. Il corpo del geocoding (count=1, meno di 1 KB
+// e una quarantina di token) parte da GEOCODE_BODY e, se non ci sta, si
+// riscarica raddoppiando fino a GEOCODE_BODY_MAX; i token si contano
+// prima e si prendono nel numero esatto, fino a GEOCODE_TOKENS.
+#define FETCH_WORK_SIZE   (8 * 1024)    // connessione, pezzo, estrattore
+#define GEOCODE_BODY      1024
+#define GEOCODE_BODY_MAX  (16 * 1024)
+#define GEOCODE_TOKENS    512
 
 // ── JSON helpers ──────────────────────────────────────────────────────────
 static int jsoneq(const char *json, jsmntok_t *tok, const char *s) {
@@ -26,89 +41,352 @@ static void tok2str(const char *json, jsmntok_t *tok,
     out[len] = '\0';
 }
 
-// ── HTTP GET con redirect ─────────────────────────────────────────────────
-static int http_get(const char *url, char *buf,
-                    u32 bufsize, u32 *bytesRead) {
-    httpcContext ctx;
-    Result rc;
+// ── Connessioni keep-alive ────────────────────────────────────────────────
+// Il sysmodule HTTP riusa la connessione TCP verso lo stesso host se le
+// richieste hanno il keep-alive attivo. Qui si tiene traccia, per host,
+// di quando l'ultima risposta ha lasciato la connessione aperta: serve
+// a ripetere una volta, su una connessione nuova, le richieste fallite
+// perche' il server l'aveva gia' chiusa. Se il riuso avvenga davvero non
+// si sa da qui: lo dicono i tempi fino alle intestazioni in NetStats.
+#define CONN_HOSTS    4
+#define CONN_IDLE_MS  (15 * 1000)
+
+typedef struct {
+    char host[64];
+    u64  last_used;
+    bool open;
+} ConnHost;
+
+static ConnHost  connHosts[CONN_HOSTS];
+static NetStats  netStats;
+static LightLock connLock;
+
+// ── Memoria dei download ──────────────────────────────────────────────────
+// Connessione, pezzo ricevuto, stato dell'estrattore, corpo e token del
+// geocoding vengono dall'arena di un contesto. Le arene sono ricavate da
+// un solo blocco preso in weather_init(), prima che lo heap si frammenti:
+// dopo l'avvio i download non allocano piu' nulla. Un contesto per ogni
+// download che puo' girare insieme agli altri (citta' corrente, le due
+// del confronto, prefetch e geocoding).
+#define FETCH_CONTEXTS    5
+#define FETCH_ARENA_SIZE  (GEOCODE_BODY_MAX + FETCH_WORK_SIZE \
+                           + GEOCODE_TOKENS * sizeof(jsmntok_t))
+
+typedef struct {
+    Arena arena;
+    bool  busy;
+} FetchCtx;
+
+static FetchCtx fetchCtx[FETCH_CONTEXTS];
+static u8      *fetchMem;
+static MemStats memStats;
+
+void weather_init(void) {
+    LightLock_Init(&connLock);
+    memset(connHosts, 0, sizeof(connHosts));
+    memset(&netStats, 0, sizeof(netStats));
+    memset(&memStats, 0, sizeof(memStats));
+
+    if (!fetchMem) fetchMem = (u8*)malloc(FETCH_CONTEXTS * FETCH_ARENA_SIZE);
+    for (int i = 0; i < FETCH_CONTEXTS; i++) {
+        arena_init(&fetchCtx[i].arena,
+                   fetchMem ? fetchMem + i * FETCH_ARENA_SIZE : NULL,
+                   FETCH_ARENA_SIZE);
+        fetchCtx[i].busy = false;
+    }
+    memStats.contexts = fetchMem ? FETCH_CONTEXTS : 0;
+    memStats.size     = FETCH_ARENA_SIZE;
+}
 
-    rc = httpcOpenContext(&ctx, HTTPC_METHOD_GET, url, 1);
-    if (R_FAILED(rc)) return -1;
+void weather_exit(void) {
+    free(fetchMem);
+    fetchMem = NULL;
+    for (int i = 0; i < FETCH_CONTEXTS; i++)
+        arena_init(&fetchCtx[i].arena, NULL, 0);
+}
 
-    httpcSetSSLOpt(&ctx, SSLCOPT_DisableVerify);
-    httpcSetKeepAlive(&ctx, HTTPC_KEEPALIVE_DISABLED);
-    httpcAddRequestHeaderField(&ctx, "User-Agent",
-                               "Mozilla/5.0 (Nintendo 3DS)");
-    httpcAddRequestHeaderField(&ctx, "Accept",       "application/json");
-    httpcAddRequestHeaderField(&ctx, "Accept-Encoding", "identity");
-    httpcAddRequestHeaderField(&ctx, "Connection",   "close");
+void weather_net_stats(NetStats *out) {
+    LightLock_Lock(&connLock);
+    *out = netStats;
+    LightLock_Unlock(&connLock);
+}
+
+void weather_mem_stats(MemStats *out) {
+    LightLock_Lock(&connLock);
+    *out = memStats;
+    LightLock_Unlock(&connLock);
+}
 
-    rc = httpcBeginRequest(&ctx);
-    if (R_FAILED(rc)) { httpcCloseContext(&ctx); return -2; }
+static Arena *ctx_acquire(void) {
+    Arena *a = NULL;
+    LightLock_Lock(&connLock);
+    for (int i = 0; i < FETCH_CONTEXTS && !a; i++)
+        if (!fetchCtx[i].busy && fetchCtx[i].arena.base) {
+            fetchCtx[i].busy = true;
+            a = &fetchCtx[i].arena;
+            arena_reset(a);
+        }
+    if (!a) memStats.fails++;
+    LightLock_Unlock(&connLock);
+    return a;
+}
+
+// Il massimo si aggiorna al rilascio: una richiesta che non ha trovato
+// spazio nell'arena conta fra i fallimenti
+static void ctx_release(Arena *a) {
+    LightLock_Lock(&connLock);
+    for (int i = 0; i < FETCH_CONTEXTS; i++)
+        if (&fetchCtx[i].arena == a) fetchCtx[i].busy = false;
+    memStats.requests++;
+    memStats.last = a->peak;
+    if (a->peak > memStats.peak) memStats.peak = a->peak;
+    memStats.fails += a->fails;
+    a->peak  = 0;
+    a->fails = 0;
+    LightLock_Unlock(&connLock);
+}
+
+static void url_host(const char *url, char *host, int maxlen) {
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    int n = 0;
+    while (p[n] && p[n] != '/' && p[n] != ':' && p[n] != '?'
+           && n < maxlen - 1) {
+        host[n] = p[n];
+        n++;
+    }
+    host[n] = '\0';
+}
+
+static ConnHost *conn_find(const char *host) {
+    ConnHost *lru = &connHosts[0];
+    for (int i = 0; i < CONN_HOSTS; i++) {
+        if (strcmp(connHosts[i].host, host) == 0) return &connHosts[i];
+        if (connHosts[i].last_used < lru->last_used) lru = &connHosts[i];
+    }
+    strncpy(lru->host, host, sizeof(lru->host) - 1);
+    lru->host[sizeof(lru->host) - 1] = '\0';
+    lru->open = false;
+    return lru;
+}
+
+// Prende la connessione aperta verso host, se c'e': fino al rilascio una
+// richiesta parallela verso lo stesso host ne aprira' un'altra.
+static bool conn_acquire(const char *host) {
+    LightLock_Lock(&connLock);
+    ConnHost *h = conn_find(host);
+    bool reuse = h->open && osGetTime() - h->last_used < CONN_IDLE_MS;
+    h->open = false;
+    netStats.requests++;
+    if (reuse) netStats.keepalive++;
+    else       netStats.connects++;
+    LightLock_Unlock(&connLock);
+    return reuse;
+}
+
+static void conn_release(const char *host, bool keep) {
+    LightLock_Lock(&connLock);
+    ConnHost *h = conn_find(host);
+    h->open      = keep;
+    h->last_used = osGetTime();
+    LightLock_Unlock(&connLock);
+}
+
+static void conn_retry(void) {
+    LightLock_Lock(&connLock);
+    netStats.keepalive--;
+    netStats.connects++;
+    netStats.retries++;
+    LightLock_Unlock(&connLock);
+}
+
+// Tempo dall'apertura alle intestazioni della risposta, diviso tra
+// connessioni nuove e richieste che potevano usare quella tenuta aperta
+static void conn_timed(bool keepalive, u64 start) {
+    u32 ms = prof_ticks_us(prof_now() - start) / 1000;
+    LightLock_Lock(&connLock);
+    if (keepalive) netStats.keepalive_ms += ms;
+    else           netStats.connect_ms   += ms;
+    LightLock_Unlock(&connLock);
+}
+
+// ── HTTP GET con redirect ─────────────────────────────────────────────────
+// I dati arrivano al sink un pezzo alla volta, man mano che vengono
+// ricevuti; un sink che ritorna != 0 interrompe il download.
+#define HTTP_CHUNK_SIZE  2048
+
+typedef int (*http_sink)(void *user, const char *data, u32 len);
+
+// Con ctl != NULL la connessione attiva viene pubblicata per poter essere
+// annullata da un altro thread, e i byte ricevuti vengono aggiornati.
+static void ctl_attach(FetchCtl *ctl, HttpConn *c) {
+    if (!ctl) return;
+    LightLock_Lock(&ctl->lock);
+    ctl->active = c;
+    LightLock_Unlock(&ctl->lock);
+}
+
+static void close_conn(FetchCtl *ctl, HttpConn *c) {
+    ctl_attach(ctl, NULL);
+    c->tp->close(c);
+}
+
+static int http_get_stream(const char *url, http_sink sink, void *user,
+                           FetchCtl *ctl, Arena *a) {
+    const Transport *tp = transport_get();
+
+    if (ctl && ctl->cancel) return WEATHER_CANCELLED;
+
+    HttpConn *c     = (HttpConn*)arena_alloc(a, sizeof(HttpConn));
+    u8       *chunk = (u8*)arena_alloc(a, HTTP_CHUNK_SIZE);
+    if (!c || !chunk) return WEATHER_NOMEM;
+
+    char host[64];
+    url_host(url, host, sizeof(host));
+    bool reused = conn_acquire(host);
+    u64  t0;
+
+retry:
+    t0 = prof_now();
+    memset(c, 0, sizeof(*c));
+    c->tp        = tp;
+    c->url       = url;
+    c->keepalive = true;
+    if (tp->open(c) < 0) { conn_release(host, false); return -1; }
+    ctl_attach(ctl, c);
+    if (ctl && ctl->cancel) {
+        close_conn(ctl, c);
+        conn_release(host, false);
+        return WEATHER_CANCELLED;
+    }
 
-    u32 statuscode = 0;
-    httpcGetResponseStatusCode(&ctx, &statuscode);
+    if (tp->begin(c) < 0) {
+        close_conn(ctl, c);
+        if (ctl && ctl->cancel) {
+            conn_release(host, false);
+            return WEATHER_CANCELLED;
+        }
+        // La connessione riusata era gia' stata chiusa dal server
+        if (reused) {
+            reused = false;
+            conn_retry();
+            goto retry;
+        }
+        conn_release(host, false);
+        return -2;
+    }
 
+    prof_end(PROF_CONNECT, t0);
+    conn_timed(reused, t0);
+    u32 statuscode = c->status;
     if (statuscode == 301 || statuscode == 302) {
-        char newurl[512] = "";
-        httpcGetResponseHeader(&ctx, "Location", newurl, sizeof(newurl));
-        httpcCloseContext(&ctx);
-        if (newurl[0]) return http_get(newurl, buf, bufsize, bytesRead);
+        char newurl[512];
+        memcpy(newurl, c->location, sizeof(newurl));
+        close_conn(ctl, c);
+        conn_release(host, false);
+        if (newurl[0]) return http_get_stream(newurl, sink, user, ctl, a);
         return -3;
     }
     if (statuscode != 200) {
-        httpcCloseContext(&ctx);
+        close_conn(ctl, c);
+        conn_release(host, false);
         return -(int)statuscode;
     }
 
-    *bytesRead = 0;
-    u8 *ptr = (u8*)buf;
-    u32 remaining = bufsize - 1;
-    Result drc;
+    u32 received = 0;
+    u64 recv = 0;
+    int rc;
     do {
-        u32 readSize = 0;
-        drc = httpcReceiveData(&ctx, ptr, remaining);
-        httpcGetDownloadSizeState(&ctx, &readSize, NULL);
-        ptr       = (u8*)buf + readSize;
-        remaining = bufsize - 1 - readSize;
-        *bytesRead = readSize;
-    } while (drc == (Result)HTTPC_RESULTCODE_DOWNLOADPENDING
-             && remaining > 0);
+        u32 got = 0;
+        u64 t = prof_now();
+        rc = tp->receive(c, chunk, HTTP_CHUNK_SIZE, &got);
+        recv += prof_now() - t;
+        if (ctl) {
+            ctl->received = c->received;
+            ctl->total    = c->total;
+            if (ctl->cancel) break;
+        }
+        if (got > 0) {
+            received += got;
+            if (sink(user, (const char*)chunk, got) != 0) break;
+        }
+    } while (rc == 1);
 
-    buf[*bytesRead] = '\0';
-    httpcCloseContext(&ctx);
-    return (*bytesRead > 0) ? 0 : -4;
-}
+    prof_add_us(PROF_RECV, prof_ticks_us(recv));
 
-// ── Geocoding ─────────────────────────────────────────────────────────────
-int weather_geocode(const char *city_name, float *lat, float *lon,
-                    char *found_name, char *timezone) {
-    char url[256];
-    char *buf = (char*)malloc(HTTP_BUF_SIZE);
-    if (!buf) return -1;
+    // Solo una risposta letta fino in fondo lascia la connessione pulita
+    close_conn(ctl, c);
+    conn_release(host, c->keepalive && rc == 0);
+    if (ctl && ctl->cancel) return WEATHER_CANCELLED;
+    return (received > 0) ? 0 : -4;
+}
 
-    char encoded[128] = {0};
-    int ei = 0;
-    for (int i = 0; city_name[i] && ei < 120; i++) {
-        if      (city_name[i] == ' ')
-            { encoded[ei++]='%'; encoded[ei++]='2'; encoded[ei++]='0'; }
-        else if (city_name[i] == ',')
-            { encoded[ei++]='%'; encoded[ei++]='2'; encoded[ei++]='C'; }
-        else encoded[ei++] = city_name[i];
+// Ritorno (> 0) di una risposta che non e' arrivata intera: corpo piu'
+// grande del buffer, o previsioni senza tutti i blocchi richiesti
+#define FETCH_TRUNCATED  1
+
+// Variante che accumula l'intera risposta in buf (terminata da '\0')
+typedef struct {
+    char *buf;
+    u32   size;
+    u32   len;
+    bool  overflow;
+} HttpBuffer;
+
+static int buffer_sink(void *user, const char *data, u32 len) {
+    HttpBuffer *b = (HttpBuffer*)user;
+    u32 room = b->size - 1 - b->len;
+    if (len > room) {
+        b->overflow = true;
+        len = room;
     }
+    memcpy(b->buf + b->len, data, len);
+    b->len += len;
+    return b->overflow;
+}
 
-    snprintf(url, sizeof(url),
-        "http://geocoding-api.open-meteo.com/v1/search"
-        "?name=%s&count=1&language=en&format=json", encoded);
+// Ritorna 0, un errore (<0) o FETCH_TRUNCATED se il corpo non ci stava
+static int http_get(const char *url, char *buf,
+                    u32 bufsize, u32 *bytesRead, Arena *a) {
+    HttpBuffer b = { buf, bufsize, 0, false };
+    int ret = http_get_stream(url, buffer_sink, &b, NULL, a);
+    buf[b.len] = '\0';
+    *bytesRead = b.len;
+    if (ret == 0 && b.overflow) return FETCH_TRUNCATED;
+    return ret;
+}
 
-    u32 bytesRead = 0;
-    int ret = http_get(url, buf, HTTP_BUF_SIZE, &bytesRead);
-    if (ret < 0) { free(buf); return ret; }
+// ── Geocoding ─────────────────────────────────────────────────────────────
+static int geocode(const char *city_name, float *lat, float *lon,
+                   char *found_name, char *timezone, Arena *a);
+
+int weather_geocode(const char *city_name, float *lat, float *lon,
+                    char *found_name, char *timezone) {
+    Arena *a = ctx_acquire();
+    if (!a) return WEATHER_NOMEM;
+    int ret = geocode(city_name, lat, lon, found_name, timezone, a);
+    ctx_release(a);
+    return ret;
+}
 
+// Due passate di jsmn: la prima senza token ne conta il numero, la
+// seconda li compila nell'arena. Una risposta incompleta o non valida
+// e' un errore, non un risultato vuoto.
+static int geocode_parse(const char *buf, u32 len, float *lat, float *lon,
+                         char *found_name, char *timezone, Arena *a) {
     jsmn_parser p;
-    jsmntok_t *tok = (jsmntok_t*)malloc(MAX_TOKENS * sizeof(jsmntok_t));
     jsmn_init(&p);
-    int r = jsmn_parse(&p, buf, bytesRead, tok, MAX_TOKENS);
+    u64 t0 = prof_now();
+    int n = jsmn_parse(&p, buf, len, NULL, 0);
+    if (n < 0) return WEATHER_BADJSON;
+    if (n > GEOCODE_TOKENS) return WEATHER_NOMEM;
+
+    jsmntok_t *tok = (jsmntok_t*)arena_alloc(a, (n ? n : 1) * sizeof(jsmntok_t));
+    if (!tok) return WEATHER_NOMEM;
+    jsmn_init(&p);
+    int r = jsmn_parse(&p, buf, len, tok, n);
+    prof_end(PROF_JSMN, t0);
+    if (r < 0) return WEATHER_BADJSON;
 
     int found = 0;
     char val[64];
@@ -127,233 +405,402 @@ int weather_geocode(const char *city_name, float *lat, float *lon,
             tok2str(buf, &tok[i+1], timezone, 40);
         }
     }
-    free(tok); free(buf);
     return (found >= 2) ? 0 : -10;
 }
 
+static int geocode(const char *city_name, float *lat, float *lon,
+                   char *found_name, char *timezone, Arena *a) {
+    char url[256];
+
+    char encoded[128] = {0};
+    int ei = 0;
+    for (int i = 0; city_name[i] && ei < 120; i++) {
+        if      (city_name[i] == ' ')
+            { encoded[ei++]='%'; encoded[ei++]='2'; encoded[ei++]='0'; }
+        else if (city_name[i] == ',')
+            { encoded[ei++]='%'; encoded[ei++]='2'; encoded[ei++]='C'; }
+        else encoded[ei++] = city_name[i];
+    }
+
+    snprintf(url, sizeof(url),
+        "http://geocoding-api.open-meteo.com/v1/search"
+        "?name=%s&count=1&language=en&format=json", encoded);
+
+    // Corpo troncato: si riscarica con il doppio dello spazio
+    for (u32 size = GEOCODE_BODY; ; size *= 2) {
+        arena_reset(a);
+        char *buf = (char*)arena_alloc(a, size);
+        if (!buf) return WEATHER_NOMEM;
+
+        u32 bytesRead = 0;
+        int ret = http_get(url, buf, size, &bytesRead, a);
+        if (ret < 0) return ret;
+        if (ret == 0)
+            return geocode_parse(buf, bytesRead, lat, lon,
+                                 found_name, timezone, a);
+        if (size >= GEOCODE_BODY_MAX) return WEATHER_BADJSON;
+    }
+}
+
+// ── URL delle previsioni ──────────────────────────────────────────────────
+// Open-Meteo accetta liste separate da virgole di coordinate e fusi
+// orari: una sola richiesta per piu' citta', finche' l'URL ci sta in
+// FORECAST_URL_MAX. Le citta' con il fuso in tz.c si chiedono in GMT e
+// si portano in ora locale durante l'estrazione, cosi' l'URL non dipende
+// dal fuso; le altre si chiedono con il loro. Il giorno prima di oggi e
+// quello dopo l'ultimo coprono i 7 giorni locali di ogni fuso.
+#define FORECAST_URL_MAX  2048
+#define FORECAST_PAST     1
+
+#define Q_CURRENT  "&current=temperature_2m,relative_humidity_2m," \
+                   "apparent_temperature,weather_code,wind_speed_10m," \
+                   "wind_direction_10m,surface_pressure"
+#define Q_HOURLY   "&hourly=temperature_2m,precipitation," \
+                   "relative_humidity_2m,weather_code"
+#define Q_DAILY    "&daily=weather_code,temperature_2m_max,temperature_2m_min," \
+                   "precipitation_sum,wind_speed_10m_max,uv_index_max"
+#define Q_DAYS     "&past_days=1&forecast_days=8"
+
+// Query per ogni combinazione di blocchi, sempre con la corrente
+static const char *const queries[WEATHER_ALL + 1] = {
+    [WEATHER_CURRENT]                  = Q_CURRENT,
+    [WEATHER_CURRENT | WEATHER_HOURLY] = Q_CURRENT Q_HOURLY Q_DAYS,
+    [WEATHER_CURRENT | WEATHER_DAILY]  = Q_CURRENT Q_DAILY Q_DAYS,
+    [WEATHER_ALL]                      = Q_CURRENT Q_HOURLY Q_DAILY Q_DAYS,
+};
+
+typedef struct {
+    char *s;
+    int   size;
+    int   len;
+} UrlBuf;
+
+static void url_put(UrlBuf *u, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void url_put(UrlBuf *u, const char *fmt, ...) {
+    if (u->len >= u->size) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(u->s + u->len, u->size - u->len, fmt, ap);
+    va_end(ap);
+    u->len = n < 0 ? u->size : u->len + n;
+}
+
+// Ritorna la lunghezza dell'URL o -1 se non ci sta
+static int forecast_url(char *url, int size, const City *list,
+                        const TzZone *const *zones, int n,
+                        const char *query) {
+    bool gmt = true;
+    for (int i = 0; i < n; i++)
+        if (!zones[i]) gmt = false;
+
+    UrlBuf u = { url, size, 0 };
+    url_put(&u, "http://api.open-meteo.com/v1/forecast?latitude=");
+    for (int i = 0; i < n; i++)
+        url_put(&u, i ? ",%.4f" : "%.4f", list[i].lat);
+    url_put(&u, "&longitude=");
+    for (int i = 0; i < n; i++)
+        url_put(&u, i ? ",%.4f" : "%.4f", list[i].lon);
+    url_put(&u, "%s&timezone=", query);
+    for (int i = 0; i < n && !(gmt && i); i++) {
+        if (i) url_put(&u, ",");
+        if (zones[i]) {
+            url_put(&u, "GMT");
+            continue;
+        }
+        for (const char *t = list[i].timezone; *t; t++)
+            url_put(&u, *t == '/' ? "%%2F" : "%c", *t);
+    }
+    return u.len < size ? u.len : -1;
+}
+
+// Scarica una risposta di api.open-meteo.com passando ogni pezzo
+// ricevuto all'estrattore, senza buffer per l'intero corpo. La risposta
+// riguarda n localita' (un array se n > 1) scritte in out[0..n-1].
+// Ritorna 0, un errore HTTP (<0) o FETCH_TRUNCATED se la risposta e'
+// arrivata incompleta o senza tutti i blocchi richiesti.
+
+// Il tempo dell'estrattore si somma su tutti i pezzi della risposta
+typedef struct {
+    WxParser p;
+    u64      ticks;
+} ParseSink;
+
+static int parser_sink(void *user, const char *data, u32 len) {
+    ParseSink *s = (ParseSink*)user;
+    u64 t = prof_now();
+    int r = wxp_feed(&s->p, data, len);
+    s->ticks += prof_now() - t;
+    return r < 0;
+}
+
+// L'arena si azzera a ogni richiesta: del download precedente non
+// serve piu' nulla
+static int fetch_blocks(const char *url, WeatherData *out, int n,
+                        const TzZone *const *zones, int blocks,
+                        FetchCtl *ctl, Arena *a) {
+    arena_reset(a);
+    ParseSink *s = (ParseSink*)arena_alloc(a, sizeof(ParseSink));
+    if (!s) return WEATHER_NOMEM;
+    s->ticks    = 0;
+    WxParser *p = &s->p;
+    wxp_init_many(p, out, n);
+    wxp_localize(p, zones, FORECAST_PAST);
+    int ret = http_get_stream(url, parser_sink, s, ctl, a);
+    prof_add_us(PROF_PARSE, prof_ticks_us(s->ticks));
+    if (ret < 0) return ret;
+
+    int got = wxp_finish(p);
+    return (got >= 0 && (got & blocks) == blocks) ? 0 : FETCH_TRUNCATED;
+}
+
 // ── Fetch dati meteo ──────────────────────────────────────────────────────
 int weather_fetch(float lat, float lon,
                   const char *timezone, WeatherData *out) {
-    char url[512];
-    char *buf = (char*)malloc(HTTP_BUF_SIZE);
-    if (!buf) return -1;
+    return weather_fetch_ctl(lat, lon, timezone, out, NULL);
+}
+
+static int fetch_forecast(const City *c, unsigned blocks, WeatherData *out,
+                          FetchCtl *ctl, Arena *a);
+
+int weather_fetch_ctl(float lat, float lon, const char *timezone,
+                      WeatherData *out, FetchCtl *ctl) {
+    City c;
+    memset(&c, 0, sizeof(c));
+    c.lat = lat;
+    c.lon = lon;
+    strncpy(c.timezone, timezone, sizeof(c.timezone) - 1);
+    return weather_fetch_blocks(&c, WEATHER_ALL, out, ctl);
+}
+
+int weather_fetch_blocks(const City *c, unsigned blocks,
+                         WeatherData *out, FetchCtl *ctl) {
+    Arena *a = ctx_acquire();
+    if (!a) return WEATHER_NOMEM;
+    u64 t0  = prof_now();
+    int ret = fetch_forecast(c, blocks & WEATHER_ALL, out, ctl, a);
+    if (ret == 0) prof_end(PROF_FETCH, t0);
+    ctx_release(a);
+    return ret;
+}
+
+// Blocchi appena estratti: ora del download, sole, validita'
+static void fetched_now(const City *c, WeatherData *w) {
+    time_t now = time(NULL);
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        if (w->blocks & (1u << b)) w->fetched[b] = now;
+    weather_sun(c, w);
+    w->valid = w->blocks != 0;
+}
+
+static int fetch_forecast(const City *c, unsigned blocks, WeatherData *out,
+                          FetchCtl *ctl, Arena *a) {
+    char url[FORECAST_URL_MAX];
+    const TzZone *zone = tz_find(c->timezone);
     memset(out, 0, sizeof(WeatherData));
 
-    char tz_enc[64] = {0};
-    int ti = 0;
-    for (int i = 0; timezone[i] && ti < 60; i++) {
-        if (timezone[i] == '/')
-            { tz_enc[ti++]='%'; tz_enc[ti++]='2'; tz_enc[ti++]='F'; }
-        else tz_enc[ti++] = timezone[i];
+    // ── Richiesta unica con tutti i blocchi chiesti ──────────────────
+    // La serie oraria copre tutti i 7 giorni (HOURLY_COUNT ore).
+    blocks |= WEATHER_CURRENT;
+    if (forecast_url(url, sizeof(url), c, &zone, 1, queries[blocks]) < 0)
+        return -1;
+    int ret = fetch_blocks(url, out, 1, &zone, blocks, ctl, a);
+    if (ret == 0) {
+        fetched_now(c, out);
+        return 0;
     }
+    if (ret < 0) return ret;
 
-    // ── Richiesta 1: dati correnti ────────────────────────────────────
-    snprintf(url, sizeof(url),
-        "http://api.open-meteo.com/v1/forecast"
-        "?latitude=%.4f&longitude=%.4f"
-        "&current=temperature_2m,relative_humidity_2m,"
-        "apparent_temperature,weather_code,wind_speed_10m,"
-        "wind_direction_10m,surface_pressure"
-        "&timezone=%s",
-        lat, lon, tz_enc);
-
-    u32 bytesRead = 0;
-    int ret = http_get(url, buf, HTTP_BUF_SIZE, &bytesRead);
-    if (ret < 0) { free(buf); return ret; }
-
-    {
-        jsmn_parser p;
-        jsmntok_t *tok = (jsmntok_t*)malloc(MAX_TOKENS * sizeof(jsmntok_t));
-        jsmn_init(&p);
-        int r = jsmn_parse(&p, buf, bytesRead, tok, MAX_TOKENS);
-        char val[32];
-        for (int i = 0; i < r - 1; i++) {
-            if (tok[i].type != JSMN_STRING) continue;
-            if (jsoneq(buf,&tok[i],"temperature_2m")==0
-                && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->temp_now = strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"relative_humidity_2m")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->humidity_now = strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"apparent_temperature")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->feels_like_now = strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"weather_code")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->weather_code_now = atoi(val);
-            } else if (jsoneq(buf,&tok[i],"wind_speed_10m")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->wind_now = strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"wind_direction_10m")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->wind_dir_now = atoi(val);
-            } else if (jsoneq(buf,&tok[i],"surface_pressure")==0
-                       && tok[i+1].type==JSMN_PRIMITIVE) {
-                tok2str(buf,&tok[i+1],val,sizeof(val));
-                out->pressure_now = strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"time")==0
-                       && tok[i+1].type==JSMN_STRING) {
-                char tstr[32];
-                tok2str(buf,&tok[i+1],tstr,sizeof(tstr));
-                if (strlen(tstr) >= 13)
-                    out->current_hour = atoi(tstr + 11);
-            }
-        }
-        free(tok);
+    // ── Fallback: risposta combinata troncata, un blocco per volta ───
+    // L'ora corrente (piccola) serve anche alle altre per l'ora locale
+    memset(out, 0, sizeof(WeatherData));
+    for (int b = 0; b < WEATHER_BLOCKS; b++) {
+        unsigned one = 1u << b;
+        if (!(blocks & one)) continue;
+        forecast_url(url, sizeof(url), c, &zone, 1,
+                     queries[one | WEATHER_CURRENT]);
+        ret = fetch_blocks(url, out, 1, &zone, one, ctl, a);
+        if (ret < 0) return ret;
+        if (ret > 0) break;     // incompleta anche da sola
     }
+    if ((out->blocks & blocks) != blocks) return WEATHER_BADJSON;
 
-    // ── Richiesta 2: oraria oggi ──────────────────────────────────────
-    snprintf(url, sizeof(url),
-        "http://api.open-meteo.com/v1/forecast"
-        "?latitude=%.4f&longitude=%.4f"
-        "&hourly=temperature_2m,precipitation,"
-        "relative_humidity_2m,weather_code"
-        "&forecast_days=1"
-        "&timezone=%s",
-        lat, lon, tz_enc);
-
-    bytesRead = 0;
-    ret = http_get(url, buf, HTTP_BUF_SIZE, &bytesRead);
-    if (ret < 0) { free(buf); return ret; }
-
-    {
-        jsmn_parser p;
-        jsmntok_t *tok = (jsmntok_t*)malloc(MAX_TOKENS * sizeof(jsmntok_t));
-        jsmn_init(&p);
-        int r = jsmn_parse(&p, buf, bytesRead, tok, MAX_TOKENS);
-        char val[32];
-        int temp_arr_count  = 0;
-        int wcode_arr_count = 0;
-
-        for (int i = 0; i < r - 1; i++) {
-            if (tok[i].type != JSMN_STRING) continue;
-            if (jsoneq(buf,&tok[i],"temperature_2m")==0
-                && tok[i+1].type==JSMN_ARRAY) {
-                temp_arr_count++;
-                if (temp_arr_count == 1) {
-                    for (int j=0;j<HOURLY_COUNT&&j<tok[i+1].size;j++) {
-                        tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                        out->hourly_temp[j]=strtof(val,NULL);
-                    }
-                }
-            } else if (jsoneq(buf,&tok[i],"precipitation")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<HOURLY_COUNT&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->hourly_precip[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"relative_humidity_2m")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<HOURLY_COUNT&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->hourly_humidity[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"weather_code")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                wcode_arr_count++;
-                if (wcode_arr_count == 1) {
-                    for (int j=0;j<HOURLY_COUNT&&j<tok[i+1].size;j++) {
-                        tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                        out->hourly_code[j]=atoi(val);
-                    }
-                }
-            }
+    fetched_now(c, out);
+    return 0;
+}
+
+// ── Blocchi ───────────────────────────────────────────────────────────────
+void weather_merge(WeatherData *dst, const WeatherData *src) {
+    if (src->blocks & WEATHER_CURRENT) {
+        dst->temp_now         = src->temp_now;
+        dst->wind_now         = src->wind_now;
+        dst->wind_dir_now     = src->wind_dir_now;
+        dst->pressure_now     = src->pressure_now;
+        dst->humidity_now     = src->humidity_now;
+        dst->feels_like_now   = src->feels_like_now;
+        dst->weather_code_now = src->weather_code_now;
+        dst->current_hour     = src->current_hour;
+        dst->utc_offset       = src->utc_offset;
+        memcpy(dst->current_date, src->current_date,
+               sizeof(dst->current_date));
+    }
+    if (src->blocks & WEATHER_HOURLY) {
+        memcpy(dst->hourly_temp,     src->hourly_temp,     sizeof(dst->hourly_temp));
+        memcpy(dst->hourly_precip,   src->hourly_precip,   sizeof(dst->hourly_precip));
+        memcpy(dst->hourly_humidity, src->hourly_humidity, sizeof(dst->hourly_humidity));
+        memcpy(dst->hourly_code,     src->hourly_code,     sizeof(dst->hourly_code));
+        dst->hourly_count = src->hourly_count;
+    }
+    // Le date arrivano con l'uno o l'altro blocco delle serie; minime,
+    // massime, pioggia e codice sono giornalieri anche quando li ha
+    // ricalcolati l'estrattore dalla serie oraria
+    if (src->blocks & (WEATHER_HOURLY | WEATHER_DAILY))
+        memcpy(dst->daily_date, src->daily_date, sizeof(dst->daily_date));
+    if (src->blocks & WEATHER_DAILY) {
+        memcpy(dst->daily_max,      src->daily_max,      sizeof(dst->daily_max));
+        memcpy(dst->daily_min,      src->daily_min,      sizeof(dst->daily_min));
+        memcpy(dst->daily_precip,   src->daily_precip,   sizeof(dst->daily_precip));
+        memcpy(dst->daily_wind_max, src->daily_wind_max, sizeof(dst->daily_wind_max));
+        memcpy(dst->daily_code,     src->daily_code,     sizeof(dst->daily_code));
+        dst->uv_index = src->uv_index;
+    }
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        if (src->blocks & (1u << b)) dst->fetched[b] = src->fetched[b];
+
+    // Il sole dipende solo dalle date: si prende con i blocchi nuovi
+    memcpy(dst->daily_sunrise, src->daily_sunrise, sizeof(dst->daily_sunrise));
+    memcpy(dst->daily_sunset,  src->daily_sunset,  sizeof(dst->daily_sunset));
+    memcpy(dst->daily_light,   src->daily_light,   sizeof(dst->daily_light));
+    dst->sunrise_hour = src->sunrise_hour;
+    dst->sunrise_min  = src->sunrise_min;
+    dst->sunset_hour  = src->sunset_hour;
+    dst->sunset_min   = src->sunset_min;
+
+    dst->blocks |= src->blocks;
+    dst->valid   = dst->blocks != 0;
+}
+
+long weather_age(const WeatherData *w, unsigned block, time_t now) {
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        if (block == (1u << b))
+            return (w->blocks & block) ? (long)(now - w->fetched[b]) : -1;
+    return -1;
+}
+
+// ── Sole ──────────────────────────────────────────────────────────────────
+// Non serve scaricarli: dipendono solo da coordinate e data. L'offset
+// di ogni giorno e' quello del suo mezzogiorno locale, cosi' i giorni
+// dopo un cambio dell'ora legale hanno gia' l'ora nuova; per i fusi
+// fuori da tz.c resta quello della risposta. Senza le serie i giorni
+// si contano dalla data di current.time.
+void weather_sun(const City *c, WeatherData *w) {
+    const TzZone *zone = tz_find(c->timezone);
+    s64 today = 0;
+    char noon[20];
+    snprintf(noon, sizeof(noon), "%.10sT12:00", w->current_date);
+    bool has_today = tz_parse_iso(noon, (int)strlen(noon), &today);
+
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        s64   t  = today + (s64)i * 86400;
+        int   y, m, d;
+        s32   off = w->utc_offset;
+        bool  ok  = false;
+        SunDay s  = { SUN_NONE, SUN_NONE, 0 };
+        if (w->daily_date[i][0]) {
+            snprintf(noon, sizeof(noon), "%.10sT12:00", w->daily_date[i]);
+            ok = tz_parse_iso(noon, (int)strlen(noon), &t);
+        } else if (has_today) {
+            tz_format_iso(t, noon, sizeof(noon));
+            ok = true;
         }
-        free(tok);
+        if (ok && sscanf(noon, "%d-%d-%d", &y, &m, &d) == 3) {
+            if (zone) off = tz_offset(zone, t - off);
+            sun_day(c->lat, c->lon, y, m, d, off, &s);
+        }
+        w->daily_sunrise[i] = s.rise;
+        w->daily_sunset[i]  = s.set;
+        w->daily_light[i]   = s.length;
     }
+    w->sunrise_hour = w->daily_sunrise[0] < 0 ? -1 : w->daily_sunrise[0] / 60;
+    w->sunrise_min  = w->daily_sunrise[0] < 0 ? -1 : w->daily_sunrise[0] % 60;
+    w->sunset_hour  = w->daily_sunset[0]  < 0 ? -1 : w->daily_sunset[0] / 60;
+    w->sunset_min   = w->daily_sunset[0]  < 0 ? -1 : w->daily_sunset[0] % 60;
+}
 
-    // ── Richiesta 3: giornaliera 7 giorni ────────────────────────────
-    snprintf(url, sizeof(url),
-        "http://api.open-meteo.com/v1/forecast"
-        "?latitude=%.4f&longitude=%.4f"
-        "&daily=weather_code,temperature_2m_max,temperature_2m_min,"
-        "precipitation_sum,wind_speed_10m_max,uv_index_max,"
-        "sunrise,sunset"
-        "&forecast_days=7"
-        "&timezone=%s",
-        lat, lon, tz_enc);
-
-    bytesRead = 0;
-    ret = http_get(url, buf, HTTP_BUF_SIZE, &bytesRead);
-    if (ret < 0) { free(buf); return ret; }
-
-    {
-        jsmn_parser p;
-        jsmntok_t *tok = (jsmntok_t*)malloc(MAX_TOKENS * sizeof(jsmntok_t));
-        jsmn_init(&p);
-        int r = jsmn_parse(&p, buf, bytesRead, tok, MAX_TOKENS);
-        char val[32];
-
-        for (int i = 0; i < r - 1; i++) {
-            if (tok[i].type != JSMN_STRING) continue;
-            if (jsoneq(buf,&tok[i],"weather_code")==0
-                && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->daily_code[j]=atoi(val);
-                }
-            } else if (jsoneq(buf,&tok[i],"time")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++)
-                    tok2str(buf,&tok[i+2+j],out->daily_date[j],12);
-            } else if (jsoneq(buf,&tok[i],"temperature_2m_max")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->daily_max[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"temperature_2m_min")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->daily_min[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"precipitation_sum")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->daily_precip[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"wind_speed_10m_max")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                for (int j=0;j<FORECAST_DAYS&&j<tok[i+1].size;j++) {
-                    tok2str(buf,&tok[i+2+j],val,sizeof(val));
-                    out->daily_wind_max[j]=strtof(val,NULL);
-                }
-            } else if (jsoneq(buf,&tok[i],"uv_index_max")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                tok2str(buf,&tok[i+2],val,sizeof(val));
-                out->uv_index=strtof(val,NULL);
-            } else if (jsoneq(buf,&tok[i],"sunrise")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                char sr[20];
-                tok2str(buf,&tok[i+2],sr,sizeof(sr));
-                if (strlen(sr)>=16) {
-                    out->sunrise_hour=atoi(sr+11);
-                    out->sunrise_min =atoi(sr+14);
-                }
-            } else if (jsoneq(buf,&tok[i],"sunset")==0
-                       && tok[i+1].type==JSMN_ARRAY) {
-                char ss[20];
-                tok2str(buf,&tok[i+2],ss,sizeof(ss));
-                if (strlen(ss)>=16) {
-                    out->sunset_hour=atoi(ss+11);
-                    out->sunset_min =atoi(ss+14);
-                }
+// ── Piu' citta' insieme ───────────────────────────────────────────────────
+// Le citta' si raggruppano nell'ordine della lista, quante ne stanno
+// nell'URL; un gruppo la cui risposta arriva incompleta si riscarica
+// citta' per citta' con fetch_forecast() (che ha a sua volta il
+// ripiego su una richiesta per blocco).
+static int fetch_group(const City *list, const TzZone *const *zones, int n,
+                       unsigned blocks, WeatherData *out,
+                       FetchCtl *ctl, Arena *a) {
+    char url[FORECAST_URL_MAX];
+    memset(out, 0, n * sizeof(WeatherData));
+    forecast_url(url, sizeof(url), list, zones, n, queries[blocks]);
+    int ret = fetch_blocks(url, out, n, zones, blocks, ctl, a);
+    if (ret == 0)
+        for (int i = 0; i < n; i++) fetched_now(&list[i], &out[i]);
+    return ret;
+}
+
+int weather_fetch_many(const City *list, int n, WeatherData *out) {
+    return weather_fetch_many_ctl(list, n, out, NULL);
+}
+
+int weather_fetch_many_ctl(const City *list, int n, WeatherData *out,
+                           FetchCtl *ctl) {
+    return weather_fetch_many_blocks(list, n, WEATHER_ALL, out, ctl);
+}
+
+int weather_fetch_many_blocks(const City *list, int n, unsigned blocks,
+                              WeatherData *out, FetchCtl *ctl) {
+    char url[FORECAST_URL_MAX];
+    const TzZone *zones[MAX_CITIES];
+    int  result = 0;
+
+    // Prima di ogni uscita anticipata: le citta' non scaricate restano
+    // con valid = 0 anche se out contiene i dati di una chiamata prima
+    if (n > 0) memset(out, 0, n * sizeof(WeatherData));
+    Arena *a = ctx_acquire();
+    if (!a) return WEATHER_NOMEM;
+    blocks = (blocks & WEATHER_ALL) | WEATHER_CURRENT;
+
+    for (int first = 0; first < n; ) {
+        int k = 1;
+        zones[0] = tz_find(list[first].timezone);
+        while (first + k < n && k < MAX_CITIES) {
+            zones[k] = tz_find(list[first + k].timezone);
+            if (forecast_url(url, sizeof(url), list + first, zones, k + 1,
+                             queries[blocks]) < 0)
+                break;
+            k++;
+        }
+
+        u64 t0  = prof_now();
+        int ret = fetch_group(list + first, zones, k, blocks, out + first,
+                              ctl, a);
+        if (ret == 0) {
+            prof_end(PROF_FETCH, t0);
+        } else if (ret == WEATHER_CANCELLED) {
+            result = ret;
+            break;
+        } else if (ret > 0) {
+            for (int i = first; i < first + k; i++) {
+                ret = fetch_forecast(&list[i], blocks, &out[i], ctl, a);
+                if (ret < 0) result = ret;
+                if (ret == WEATHER_CANCELLED) break;
             }
+        } else {
+            result = ret;
         }
-        free(tok);
+        if (result == WEATHER_CANCELLED) break;
+        first += k;
     }
 
-    free(buf);
-    out->valid = 1;
-    return 0;
+    ctx_release(a);
+    return result;
 }
 
 // ── Descrizioni codici WMO ────────────────────────────────────────────────
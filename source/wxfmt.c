@@ -0,0 +1,208 @@
+#include "wxfmt.h"
+#include "ansi.h"
+#include "prof.h"
+#include <stdbool.h>
+#include <string.h>
+
+// ── Numeri ────────────────────────────────────────────────────────────────
+// Un solo passaggio da float a intero, in mezze unita' dell'ultima cifra;
+// l'arrotondamento (meta' lontano da zero) e le cifre, scritte al
+// contrario in un buffer temporaneo, sono su interi. Il prodotto e' in
+// float, quindi un valore appena sotto la meta' puo' salire (0.35 con un
+// decimale da' 0.4): al piu' una unita' dell'ultima cifra dal printf.
+// I valori oltre FIXED_MAX si fermano li': nessun dato meteo ci arriva,
+// e cosi' le righe restano entro le misure di WxLines.
+#define FIXED_MAX  99999.f
+
+char *wxfmt_fixed(char *dst, float v, int width, int dec) {
+    static const float scale[3] = { 2.f, 20.f, 200.f };
+    if (dec < 0) dec = 0;
+    if (dec > 2) dec = 2;
+
+    if (v >  FIXED_MAX) v =  FIXED_MAX;
+    if (v < -FIXED_MAX) v = -FIXED_MAX;
+    s32  h   = (s32)(v * scale[dec]);
+    bool neg = h < 0;
+    u32  u   = neg ? (u32)-h : (u32)h;
+    u = (u >> 1) + (u & 1);
+    neg = neg && u != 0;
+
+    char tmp[16];
+    int  n = 0;
+    for (int i = 0; i < dec; i++) { tmp[n++] = (char)('0' + u % 10); u /= 10; }
+    if (dec) tmp[n++] = '.';
+    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u && n < 14);
+    if (neg) tmp[n++] = '-';
+
+    for (int i = n; i < width; i++) *dst++ = ' ';
+    while (n) *dst++ = tmp[--n];
+    *dst = '\0';
+    return dst;
+}
+
+static char *put_str(char *p, const char *s) {
+    while (*s) *p++ = *s++;
+    *p = '\0';
+    return p;
+}
+
+static char *put_2d(char *p, int v) {
+    if (v < 0)  v = 0;
+    if (v > 99) v = 99;
+    *p++ = (char)('0' + v / 10);
+    *p++ = (char)('0' + v % 10);
+    *p   = '\0';
+    return p;
+}
+
+// "HH:MM", "--:--" se l'ora manca (h < 0)
+static char *put_time(char *p, int h, int m) {
+    if (h < 0) return put_str(p, "--:--");
+    p = put_2d(p, h);
+    *p++ = ':';
+    return put_2d(p, m);
+}
+
+// ── Righe ─────────────────────────────────────────────────────────────────
+// Giorno del mese dell'ora i ("DD" da daily_date), "--" se manca
+static char *put_day(char *p, const WeatherData *w, int i) {
+    const char *d = w->daily_date[i / 24];
+    if (strlen(d) >= 10) { *p++ = d[8]; *p++ = d[9]; }
+    else                 { *p++ = '-'; *p++ = '-'; }
+    *p = '\0';
+    return p;
+}
+
+// Stesso testo di " %s %02d:00 %4.1fC %3.1fmm %3.0f%% %s" (giorno, ora)
+static void hourly_row(char *p, const WeatherData *w, int i) {
+    const char *icon = weather_code_icon(w->hourly_code[i]);
+    bool now = (i == w->current_hour);
+
+    p = put_str(p, now ? C_YLW C_BLD " " : C_WHT " ");
+    p = put_day(p, w, i);
+    p = put_str(p, " ");
+    p = put_2d(p, i % 24);
+    p = put_str(p, now ? ":00 " : ":00" C_YLW " ");
+    p = wxfmt_fixed(p, w->hourly_temp[i], 4, 1);
+    p = put_str(p, now ? "C " : "C" C_CYN " ");
+    p = wxfmt_fixed(p, w->hourly_precip[i], 3, 1);
+    p = put_str(p, now ? "mm " : "mm" C_BLU " ");
+    p = wxfmt_fixed(p, w->hourly_humidity[i], 3, 0);
+    p = put_str(p, now ? "% " : "%" C_GRN " ");
+    p = put_str(p, icon);
+    put_str(p, now ? "<" C_RST : C_RST);
+}
+
+// " %02d:00 %4.1fC %3.1fmm %s"
+static void hour_short_row(char *p, const WeatherData *w, int i) {
+    p = put_str(p, " ");
+    p = put_2d(p, i % 24);
+    p = put_str(p, ":00 ");
+    p = wxfmt_fixed(p, w->hourly_temp[i], 4, 1);
+    p = put_str(p, "C ");
+    p = wxfmt_fixed(p, w->hourly_precip[i], 3, 1);
+    p = put_str(p, "mm ");
+    put_str(p, weather_code_icon(w->hourly_code[i]));
+}
+
+// " %s %3.0fC %3.0fC %3.1fmm %3.0fkm %s"
+static void daily_row(char *p, const WeatherData *w, int i) {
+    p = put_str(p, " ");
+    p = put_str(p, w->daily_date[i]);
+    p = put_str(p, " ");
+    p = wxfmt_fixed(p, w->daily_max[i], 3, 0);
+    p = put_str(p, "C ");
+    p = wxfmt_fixed(p, w->daily_min[i], 3, 0);
+    p = put_str(p, "C ");
+    p = wxfmt_fixed(p, w->daily_precip[i], 3, 1);
+    p = put_str(p, "mm ");
+    p = wxfmt_fixed(p, w->daily_wind_max[i], 3, 0);
+    p = put_str(p, "km ");
+    put_str(p, weather_code_icon(w->daily_code[i]));
+}
+
+// " MM-DD  HH:MM  HH:MM  HHhMM": alba, tramonto, durata del giorno
+static void sun_row(char *p, const WeatherData *w, int i) {
+    int rise = w->daily_sunrise[i], set = w->daily_sunset[i];
+    int len  = w->daily_light[i];
+    const char *d = w->daily_date[i];
+    p = put_str(p, " ");
+    p = put_str(p, strlen(d) >= 10 ? d + 5 : "--");
+    p = put_str(p, "  ");
+    p = put_time(p, rise < 0 ? -1 : rise / 60, rise % 60);
+    p = put_str(p, "  ");
+    p = put_time(p, set < 0 ? -1 : set / 60, set % 60);
+    p = put_str(p, "  ");
+    p = put_2d(p, len / 60);
+    *p++ = 'h';
+    put_2d(p, len % 60);
+}
+
+void wxfmt_build(const WeatherData *w, WxLines *out) {
+    PROF_SCOPE(PROF_FORMAT);
+    put_str(wxfmt_fixed(out->temp,  w->temp_now,       0, 1), "C");
+    put_str(wxfmt_fixed(out->feels, w->feels_like_now, 0, 1), "C");
+    put_str(wxfmt_fixed(out->humidity, w->humidity_now, 0, 0), "%");
+    wxfmt_fixed(out->pressure,  w->pressure_now, 0, 0);
+    wxfmt_fixed(out->pressure1, w->pressure_now, 0, 1);
+    wxfmt_fixed(out->wind,      w->wind_now,     0, 1);
+    if (w->blocks & WEATHER_DAILY)
+        wxfmt_fixed(out->uv, w->uv_index, 0, 1);
+    else
+        put_str(out->uv, "--");
+    put_time(out->sunrise, w->sunrise_hour, w->sunrise_min);
+    put_time(out->sunset,  w->sunset_hour,  w->sunset_min);
+
+    for (int i = 0; i < w->hourly_count; i++) {
+        hourly_row(out->hourly[i], w, i);
+        hour_short_row(out->hour_short[i], w, i);
+    }
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        daily_row(out->daily[i], w, i);
+        sun_row(out->sun[i], w, i);
+    }
+}
+
+// ── Cache ─────────────────────────────────────────────────────────────────
+// Due voci, quante i dati mostrati insieme nel confronto citta'. Una voce
+// si riconosce dalla citta' e dall'ora di download di ogni blocco: i dati
+// cambiano solo con un download, che aggiorna fetched[].
+#define WXF_SLOTS  2
+
+typedef struct {
+    char     city[CITY_NAME_LEN];
+    time_t   fetched[WEATHER_BLOCKS];
+    unsigned blocks;
+    bool     used;
+    WxLines  lines;
+} WxSlot;
+
+static WxSlot slots[WXF_SLOTS];
+static int    lastSlot;
+
+static bool slot_match(const WxSlot *s, const WeatherData *w,
+                       const char *city) {
+    return s->used && s->blocks == w->blocks
+        && memcmp(s->fetched, w->fetched, sizeof(s->fetched)) == 0
+        && strcmp(s->city, city) == 0;
+}
+
+const WxLines *wxfmt_lines(const WeatherData *w, const char *city) {
+    for (int i = 0; i < WXF_SLOTS; i++) {
+        if (slot_match(&slots[i], w, city)) {
+            lastSlot = i;
+            return &slots[i].lines;
+        }
+    }
+    // Sostituisce la voce non usata per ultima
+    int i = (lastSlot + 1) % WXF_SLOTS;
+    WxSlot *s = &slots[i];
+    strncpy(s->city, city, sizeof(s->city) - 1);
+    s->city[sizeof(s->city) - 1] = '\0';
+    memcpy(s->fetched, w->fetched, sizeof(s->fetched));
+    s->blocks = w->blocks;
+    s->used   = true;
+    wxfmt_build(w, &s->lines);
+    lastSlot = i;
+    return &s->lines;
+}
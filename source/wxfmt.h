@@ -0,0 +1,46 @@
+#ifndef WXFMT_H
+#define WXFMT_H
+
+#include "weather.h"
+
+// Testi gia' formattati di un WeatherData: si calcolano una volta sola
+// quando arrivano i dati, con un formattatore a virgola fissa su interi,
+// e le schermate li stampano senza passare dal printf dei float.
+// Le etichette non sono incluse perche' dipendono dalla lingua.
+
+// Misure delle righe con i valori piu' larghi di wxfmt_fixed()
+#define WXF_ROW    72     // oraria con i colori
+#define WXF_SHORT  32     // oraria breve, sole
+#define WXF_DAY    48
+
+typedef struct {
+    char temp[12];        // "16.8C"
+    char feels[12];
+    char humidity[8];     // "18%"
+    char pressure[12];    // "1013"
+    char pressure1[12];   // "1013.4"
+    char wind[12];        // "22.0"
+    char uv[8];           // "6.8"
+    char sunrise[8];      // "06:30"
+    char sunset[8];
+
+    // Righe della tabella oraria (giorno del mese e ora) con i colori,
+    // l'ora corrente evidenziata; valide le prime w->hourly_count
+    char hourly[HOURLY_COUNT][WXF_ROW];
+    // Righe brevi (ora, temperatura, pioggia, icona) senza colori
+    char hour_short[HOURLY_COUNT][WXF_SHORT];
+    char daily[FORECAST_DAYS][WXF_DAY];
+    // Alba, tramonto e durata del giorno: " 10-18  06:30  17:15  10h45"
+    char sun[FORECAST_DAYS][WXF_SHORT];
+} WxLines;
+
+// Testi per i dati w della citta' city: rifatti solo dopo un nuovo
+// download (fetched[] diverso) o per un'altra citta'
+const WxLines *wxfmt_lines(const WeatherData *w, const char *city);
+void           wxfmt_build(const WeatherData *w, WxLines *out);
+
+// v con dec decimali (0-2), allineato a destra su width caratteri, al
+// piu' 9 caratteri oltre gli spazi; ritorna il puntatore al terminatore
+char *wxfmt_fixed(char *dst, float v, int width, int dec);
+
+#endif
@@ -0,0 +1,358 @@
+#include "wxparse.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    S_VALUE = 0,
+    S_STRING,
+    S_STRING_ESC,
+    S_SCALAR
+};
+
+enum {
+    K_NONE = 0,
+    K_CURRENT, K_HOURLY, K_DAILY,
+    K_TIME, K_TEMP, K_HUMIDITY, K_APPARENT, K_CODE,
+    K_WIND, K_WIND_DIR, K_PRESSURE, K_PRECIP,
+    K_TMAX, K_TMIN, K_PRECIP_SUM, K_WIND_MAX, K_UV_MAX,
+    K_UTC_OFFSET
+};
+
+// ── Tabella chiavi ────────────────────────────────────────────────────────
+// Switch su lunghezza e primo carattere: al massimo due memcmp per chiave.
+#define KEY_IS(s)  (memcmp(k, s, sizeof(s) - 1) == 0)
+
+static int key_lookup(const char *k, int len) {
+    switch (len) {
+    case 4:
+        if (KEY_IS("time"))                 return K_TIME;
+        break;
+    case 5:
+        if (KEY_IS("daily"))                return K_DAILY;
+        break;
+    case 6:
+        if (KEY_IS("hourly"))               return K_HOURLY;
+        break;
+    case 7:
+        if (KEY_IS("current"))              return K_CURRENT;
+        break;
+    case 12:
+        if (k[0] == 'w' && KEY_IS("weather_code")) return K_CODE;
+        if (k[0] == 'u' && KEY_IS("uv_index_max")) return K_UV_MAX;
+        break;
+    case 13:
+        if (KEY_IS("precipitation"))        return K_PRECIP;
+        break;
+    case 14:
+        if (k[0] == 't' && KEY_IS("temperature_2m")) return K_TEMP;
+        if (k[0] == 'w' && KEY_IS("wind_speed_10m")) return K_WIND;
+        break;
+    case 16:
+        if (KEY_IS("surface_pressure"))     return K_PRESSURE;
+        break;
+    case 17:
+        if (KEY_IS("precipitation_sum"))    return K_PRECIP_SUM;
+        break;
+    case 18:
+        if (k[0] == 't') {
+            if (KEY_IS("temperature_2m_max")) return K_TMAX;
+            if (KEY_IS("temperature_2m_min")) return K_TMIN;
+        } else if (k[0] == 'w') {
+            if (KEY_IS("wind_direction_10m")) return K_WIND_DIR;
+            if (KEY_IS("wind_speed_10m_max")) return K_WIND_MAX;
+        } else if (k[0] == 'u') {
+            if (KEY_IS("utc_offset_seconds")) return K_UTC_OFFSET;
+        }
+        break;
+    case 20:
+        if (k[0] == 'r' && KEY_IS("relative_humidity_2m")) return K_HUMIDITY;
+        if (k[0] == 'a' && KEY_IS("apparent_temperature")) return K_APPARENT;
+        break;
+    }
+    return K_NONE;
+}
+
+#undef KEY_IS
+
+// ── Scrittura valori ──────────────────────────────────────────────────────
+static void put_current(WeatherData *w, int key, const char *v, int len) {
+    switch (key) {
+    case K_TEMP:     w->temp_now         = strtof(v, NULL); break;
+    case K_HUMIDITY: w->humidity_now     = strtof(v, NULL); break;
+    case K_APPARENT: w->feels_like_now   = strtof(v, NULL); break;
+    case K_CODE:     w->weather_code_now = atoi(v);         break;
+    case K_WIND:     w->wind_now         = strtof(v, NULL); break;
+    case K_WIND_DIR: w->wind_dir_now     = atoi(v);         break;
+    case K_PRESSURE: w->pressure_now     = strtof(v, NULL); break;
+    case K_TIME:
+        if (len >= 13) w->current_hour = atoi(v + 11);
+        if (len >= 10) {
+            memcpy(w->current_date, v, 10);
+            w->current_date[10] = '\0';
+        }
+        break;
+    }
+}
+
+static void put_hourly(WeatherData *w, int key, int i, const char *v) {
+    if (i >= HOURLY_COUNT) return;
+    if (i >= w->hourly_count) w->hourly_count = i + 1;
+    switch (key) {
+    case K_TEMP:     w->hourly_temp[i]     = strtof(v, NULL); break;
+    case K_PRECIP:   w->hourly_precip[i]   = strtof(v, NULL); break;
+    case K_HUMIDITY: w->hourly_humidity[i] = strtof(v, NULL); break;
+    case K_CODE:     w->hourly_code[i]     = atoi(v);         break;
+    }
+}
+
+static void put_daily(WeatherData *w, int key, int i,
+                      const char *v, int len) {
+    if (i >= FORECAST_DAYS) return;
+    switch (key) {
+    case K_CODE:       w->daily_code[i]     = atoi(v);         break;
+    case K_TMAX:       w->daily_max[i]      = strtof(v, NULL); break;
+    case K_TMIN:       w->daily_min[i]      = strtof(v, NULL); break;
+    case K_PRECIP_SUM: w->daily_precip[i]   = strtof(v, NULL); break;
+    case K_WIND_MAX:   w->daily_wind_max[i] = strtof(v, NULL); break;
+    case K_TIME: {
+        int n = len < 11 ? len : 11;
+        memcpy(w->daily_date[i], v, n);
+        w->daily_date[i][n] = '\0';
+        break;
+    }
+    case K_UV_MAX:
+        if (i == 0) w->uv_index = strtof(v, NULL);
+        break;
+    }
+}
+
+// ── Ora locale ────────────────────────────────────────────────────────────
+static int floor_hours(s32 sec) {
+    return sec >= 0 ? sec / 3600 : -((-sec + 3599) / 3600);
+}
+
+// "current.time" in GMT: fissa l'offset della localita' e dove iniziano
+// le serie di oggi. Le serie partono dalla mezzanotte UTC di past giorni
+// fa; la mezzanotte locale di oggi cade hshift ore dopo.
+static void set_now(WxParser *p, s64 utc) {
+    p->off = tz_offset(p->zone, utc);
+    p->out->utc_offset = p->off;
+    s64 local = utc + p->off;
+    int dd    = (int)((local >= 0 ? local / 86400 : (local - 86399) / 86400)
+                    - (utc >= 0 ? utc / 86400 : (utc - 86399) / 86400));
+    p->dshift = p->past + dd;
+    p->hshift = 24 * p->dshift - floor_hours(p->off);
+}
+
+// Istante GMT riscritto in ora locale in out; false se non e' una data
+static bool to_local(WxParser *p, const char *v, int len, char *out, int max) {
+    s64 t;
+    if (!tz_parse_iso(v, len, &t)) return false;
+    tz_format_iso(t + p->off, out, max);
+    return true;
+}
+
+// Le serie sono in ora locale: il giorno d sono le ore 24d..24d+23
+static void daily_from_hourly(WeatherData *w) {
+    for (int d = 0; d < FORECAST_DAYS && (d + 1) * 24 <= w->hourly_count; d++) {
+        const float *t = &w->hourly_temp[d * 24];
+        float mx = t[0], mn = t[0], rain = 0;
+        int   code = 0;
+        for (int h = 0; h < 24; h++) {
+            if (t[h] > mx) mx = t[h];
+            if (t[h] < mn) mn = t[h];
+            rain += w->hourly_precip[d * 24 + h];
+            if (w->hourly_code[d * 24 + h] > code)
+                code = w->hourly_code[d * 24 + h];
+        }
+        w->daily_max[d]    = mx;
+        w->daily_min[d]    = mn;
+        w->daily_precip[d] = rain;
+        w->daily_code[d]   = code;
+    }
+}
+
+// Valore completo (stringa o primitivo) nello scratch buffer.
+// Profondita' relative alla localita' (b = base): 1 = oggetto della
+// localita', 2 = blocco, 3 = array di un blocco.
+static void on_value(WxParser *p) {
+    const char *v = p->scratch;
+    int  b = p->base;
+    int  d = p->depth - b;
+    char loc[20];
+
+    if (!p->out) return;
+    if (p->slen == 4 && memcmp(v, "null", 4) == 0) return;
+
+    if (d == 1 && p->key[b + 1] == K_UTC_OFFSET) {
+        // In GMT e' 0: l'offset vero lo fissa set_now()
+        if (!p->zone) p->out->utc_offset = atoi(v);
+    } else if (d == 2 && !p->is_array[b + 2] && p->key[b + 1] == K_CURRENT) {
+        int key = p->key[b + 2];
+        s64 utc;
+        if (key == K_TIME && p->zone && tz_parse_iso(v, p->slen, &utc)) {
+            set_now(p, utc);
+            to_local(p, v, p->slen, loc, sizeof(loc));
+            put_current(p->out, key, loc, (int)strlen(loc));
+        } else {
+            put_current(p->out, key, v, p->slen);
+        }
+    } else if (d == 3 && p->is_array[b + 3] && !p->is_array[b + 2]) {
+        int key = p->key[b + 2];
+        int i   = p->index[b + 3];
+        if (p->key[b + 1] == K_HOURLY) {
+            if (i < p->hshift) return;
+            i -= p->hshift;
+            // La prima ora di ogni giorno ne da' la data, anche se il
+            // blocco giornaliero non e' (ancora) scaricato
+            if (key == K_TIME && i % 24 == 0 && i < HOURLY_COUNT) {
+                if (p->zone && to_local(p, v, p->slen, loc, sizeof(loc)))
+                    put_daily(p->out, K_TIME, i / 24, loc, 10);
+                else if (p->slen >= 10)
+                    put_daily(p->out, K_TIME, i / 24, v, 10);
+            } else {
+                put_hourly(p->out, key, i, v);
+            }
+        } else if (p->key[b + 1] == K_DAILY && i >= p->dshift) {
+            put_daily(p->out, key, i - p->dshift, v, p->slen);
+        }
+    }
+}
+
+// Apertura dell'oggetto di una localita': la radice, o un elemento
+// dell'array radice
+static void on_item(WxParser *p) {
+    int i = p->base ? p->index[1] : 0;
+    p->out    = i < p->count ? &p->list[i] : NULL;
+    p->cur    = 0;
+    p->zone   = (p->zones && p->out) ? p->zones[i] : NULL;
+    p->off    = 0;
+    p->hshift = 24 * p->past;
+    p->dshift = p->past;
+}
+
+static void on_close(WxParser *p) {
+    int b = p->base;
+    int d = p->depth - b;
+    if (d == 2 && !p->is_array[b + 2]) {
+        switch (p->key[b + 1]) {
+        case K_CURRENT: p->cur |= WXP_CURRENT; break;
+        case K_HOURLY:  p->cur |= WXP_HOURLY;  break;
+        case K_DAILY:   p->cur |= WXP_DAILY;   break;
+        }
+    } else if (d == 1 && p->out) {
+        if (p->zone) daily_from_hourly(p->out);
+        p->out->blocks |= p->cur;
+        p->blocks = p->items ? (p->blocks & p->cur) : p->cur;
+        p->items++;
+        p->out = NULL;
+    }
+    p->depth--;
+    if (p->depth == 0) p->done = 1;
+}
+
+// ── API ───────────────────────────────────────────────────────────────────
+void wxp_init(WxParser *p, WeatherData *out) {
+    wxp_init_many(p, out, 1);
+}
+
+void wxp_init_many(WxParser *p, WeatherData *out, int count) {
+    memset(p, 0, sizeof(*p));
+    p->list  = out;
+    p->count = count;
+}
+
+void wxp_localize(WxParser *p, const TzZone *const *zones, int past_days) {
+    p->zones = zones;
+    p->past  = past_days;
+}
+
+int wxp_feed(WxParser *p, const char *data, size_t len) {
+    for (size_t i = 0; i < len && !p->error; i++) {
+        char c = data[i];
+
+        switch (p->state) {
+        case S_STRING_ESC:
+            if (p->slen < WXP_SCALAR_LEN - 1) p->scratch[p->slen++] = c;
+            p->state = S_STRING;
+            continue;
+
+        case S_STRING:
+            if (c == '\\') {
+                p->state = S_STRING_ESC;
+            } else if (c == '"') {
+                p->scratch[p->slen] = '\0';
+                p->state = S_VALUE;
+                if (p->expect_key && !p->is_array[p->depth]) {
+                    p->key[p->depth] = (signed char)key_lookup(p->scratch,
+                                                               p->slen);
+                    p->expect_key = 0;
+                } else {
+                    on_value(p);
+                }
+            } else if (p->slen < WXP_SCALAR_LEN - 1) {
+                p->scratch[p->slen++] = c;
+            }
+            continue;
+
+        case S_SCALAR:
+            if (c != ',' && c != '}' && c != ']' && c != ' ' &&
+                c != '\t' && c != '\r' && c != '\n') {
+                if (p->slen < WXP_SCALAR_LEN - 1) p->scratch[p->slen++] = c;
+                continue;
+            }
+            p->scratch[p->slen] = '\0';
+            p->state = S_VALUE;
+            on_value(p);
+            break;  // il delimitatore va ancora elaborato
+        }
+
+        switch (c) {
+        case '{': case '[':
+            if (p->depth + 1 >= WXP_MAX_DEPTH) { p->error = 1; break; }
+            p->depth++;
+            p->is_array[p->depth] = (c == '[');
+            p->key[p->depth]      = K_NONE;
+            p->index[p->depth]    = 0;
+            p->expect_key         = (c == '{');
+            if (p->depth == 1 && c == '[') p->base = 1;
+            else if (p->depth == p->base + 1 && c == '{') on_item(p);
+            break;
+        case '}': case ']':
+            // Chiude il contenitore aperto a questa profondita' o e'
+            // un documento malformato, non uno completo
+            if (p->depth == 0 || p->is_array[p->depth] != (c == ']')) {
+                p->error = 1;
+                break;
+            }
+            on_close(p);
+            p->expect_key = 0;
+            break;
+        case ':':
+            p->expect_key = 0;
+            break;
+        case ',':
+            if (p->is_array[p->depth]) p->index[p->depth]++;
+            else                       p->expect_key = 1;
+            break;
+        case '"':
+            p->slen  = 0;
+            p->state = S_STRING;
+            break;
+        case ' ': case '\t': case '\r': case '\n':
+            break;
+        default:
+            if (p->depth == 0) { p->error = 1; break; }
+            p->slen = 0;
+            p->scratch[p->slen++] = c;
+            p->state = S_SCALAR;
+            break;
+        }
+    }
+    return p->error ? -1 : 0;
+}
+
+int wxp_finish(WxParser *p) {
+    if (p->error || !p->done || p->state != S_VALUE) return -1;
+    return p->items >= p->count ? (int)p->blocks : 0;
+}
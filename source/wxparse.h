@@ -0,0 +1,68 @@
+#ifndef WXPARSE_H
+#define WXPARSE_H
+
+#include <stddef.h>
+#include "weather.h"
+#include "tz.h"
+
+// Estrattore JSON a passata singola per le risposte di api.open-meteo.com.
+// Scrive i valori direttamente in WeatherData senza array di token; puo'
+// ricevere la risposta intera o a pezzi con chiamate successive a
+// wxp_feed(). Una richiesta con piu' coordinate risponde con un array
+// di oggetti, uno per localita': wxp_init_many() li scrive nell'ordine
+// in out[0..count-1].
+//
+// Con wxp_localize() la risposta e' chiesta in GMT con past_days giorni
+// prima di oggi: l'ora corrente e l'inizio delle serie orarie e
+// giornaliere si portano nell'ora locale del fuso di ogni localita'
+// (NULL: risposta gia' in ora locale, si saltano solo i giorni passati),
+// con l'offset valido nell'istante di "current.time". Minime, massime,
+// pioggia e codice del giorno si ricalcolano sulle 24 ore locali (se
+// nella risposta c'e' la serie oraria: da soli restano quelli dei
+// giorni UTC). La serie oraria da' anche le date dei giorni.
+
+#define WXP_MAX_DEPTH   8
+#define WXP_SCALAR_LEN  32
+
+// Blocchi ricevuti: gli stessi bit di WeatherData.blocks, che
+// l'estrattore aggiorna per ogni localita'
+#define WXP_CURRENT     WEATHER_CURRENT
+#define WXP_HOURLY      WEATHER_HOURLY
+#define WXP_DAILY       WEATHER_DAILY
+#define WXP_ALL         WEATHER_ALL
+
+typedef struct {
+    WeatherData  *out;      // localita' corrente, NULL se oltre count
+    WeatherData  *list;
+    int           count;
+    int           base;     // 1 se la radice e' un array di localita'
+    int           items;    // localita' chiuse
+    unsigned      cur;      // blocchi della localita' corrente
+    const TzZone *const *zones;
+    int           past;
+    const TzZone *zone;     // fuso della localita' corrente
+    s32           off;      // suo offset in secondi
+    int           hshift;   // prima ora e primo giorno di oggi nelle serie
+    int           dshift;
+    int           state;
+    char          scratch[WXP_SCALAR_LEN];
+    int           slen;
+    int           depth;
+    int           expect_key;
+    unsigned char is_array[WXP_MAX_DEPTH];
+    signed char   key[WXP_MAX_DEPTH];
+    int           index[WXP_MAX_DEPTH];
+    unsigned      blocks;
+    int           done;
+    int           error;
+} WxParser;
+
+void wxp_init(WxParser *p, WeatherData *out);
+void wxp_init_many(WxParser *p, WeatherData *out, int count);
+void wxp_localize(WxParser *p, const TzZone *const *zones, int past_days);
+int  wxp_feed(WxParser *p, const char *data, size_t len);
+// Blocchi ricevuti per intero da tutte le count localita' (0 se ne
+// mancano), o -1 se il documento e' malformato o troncato
+int  wxp_finish(WxParser *p);
+
+#endif
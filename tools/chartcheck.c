@@ -0,0 +1,134 @@
+// Verifica e misura di chart.c su un framebuffer in memoria.
+// Disegna i grafici orario e giornaliero di dati sintetici nello schermo
+// inferiore (40x30 celle), confronta il risultato con l'immagine di
+// riferimento e misura il tempo di un ridisegno completo (anche come
+// sezione "chart" di prof.h).
+//
+//   chartcheck [-w] [immagine.ppm]
+//
+// Con -w scrive l'immagine invece di confrontarla (dopo una modifica
+// voluta al disegno, da controllare a occhio prima di salvarla).
+
+#include "chart.h"
+#include "render.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLS    40
+#define WIDTH   (COLS * 8)
+#define GOLDEN  "tools/golden/charts.ppm"
+
+static u16 fb[WIDTH * RENDER_FB_HEIGHT];
+static u8  font[256 * 8];
+static u8  rgb[WIDTH * RENDER_FB_HEIGHT * 3];
+
+// Generatore fisso: l'immagine non dipende dalla libc
+static u32 seed = 2463534242u;
+static u32 next_rand(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Andamento a triangolo, senza libm per lo stesso motivo
+static float wave(int i, int period, float lo, float hi) {
+    int k = i % period;
+    int t = k < period / 2 ? k : period - k;
+    return lo + (hi - lo) * t / (period / 2);
+}
+
+static void sample(WeatherData *w) {
+    memset(w, 0, sizeof(*w));
+    w->hourly_count = HOURLY_COUNT;
+    w->current_hour = 14;
+    for (int i = 0; i < HOURLY_COUNT; i++) {
+        w->hourly_temp[i]   = wave(i + 18, 24, -3.5f, 11.2f) + i / 24;
+        w->hourly_precip[i] = (i % 7 < 3) ? (i % 5) * 0.7f : 0.f;
+    }
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        snprintf(w->daily_date[i], sizeof(w->daily_date[i]),
+                 "2026-10-%02d", 18 + i);
+        w->daily_max[i] = wave(i, 4, 8.f, 17.5f);
+        w->daily_min[i] = w->daily_max[i] - 6.f - i % 3;
+    }
+}
+
+// RGB565 -> RGB888 in ordine di schermo (riga per riga)
+static void to_rgb(void) {
+    u8 *p = rgb;
+    for (int y = 0; y < RENDER_FB_HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++) {
+            u16 c = fb[x * RENDER_FB_HEIGHT + (RENDER_FB_HEIGHT - 1 - y)];
+            *p++ = (u8)((c >> 11) << 3);
+            *p++ = (u8)(((c >> 5) & 63) << 2);
+            *p++ = (u8)((c & 31) << 3);
+        }
+}
+
+static void draw(const WeatherData *w) {
+    Chart hourly, daily;
+    chart_hourly(&hourly, w, 0, 24, 4, 14);
+    chart_daily(&daily, w, 18, 12);
+    chart_draw(&hourly);
+    chart_draw(&daily);
+}
+
+int main(int argc, char **argv) {
+    bool write = argc > 1 && strcmp(argv[1], "-w") == 0;
+    const char *path = argc > 1 + write ? argv[1 + write] : GOLDEN;
+
+    prof_init();
+    for (int i = 0; i < (int)sizeof(font); i++) font[i] = (u8)next_rand();
+    render_init(font, 0, 256);
+    chart_target(fb, COLS);
+
+    WeatherData w;
+    sample(&w);
+    draw(&w);
+    to_rgb();
+
+    if (write) {
+        FILE *f = fopen(path, "wb");
+        if (!f) { perror(path); return 1; }
+        fprintf(f, "P6\n%d %d\n255\n", WIDTH, RENDER_FB_HEIGHT);
+        fwrite(rgb, 1, sizeof(rgb), f);
+        fclose(f);
+        printf("written %s\n", path);
+        return 0;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return 1; }
+    int gw = 0, gh = 0, max = 0;
+    static u8 gold[sizeof(rgb)];
+    bool ok = fscanf(f, "P6 %d %d %d", &gw, &gh, &max) == 3
+           && gw == WIDTH && gh == RENDER_FB_HEIGHT && fgetc(f) != EOF
+           && fread(gold, 1, sizeof(gold), f) == sizeof(gold);
+    fclose(f);
+    if (!ok) { printf("%s: not a %dx%d PPM\n", path, WIDTH, RENDER_FB_HEIGHT); return 1; }
+
+    int diff = 0;
+    for (int i = 0; i < WIDTH * RENDER_FB_HEIGHT; i++)
+        if (memcmp(rgb + i * 3, gold + i * 3, 3) != 0) {
+            if (!diff)
+                printf("first mismatch at %d,%d\n",
+                       i % WIDTH, i / WIDTH);
+            diff++;
+        }
+    if (diff) {
+        printf("%d pixels differ from %s\n", diff, path);
+        return 1;
+    }
+
+    int passes = 2000;
+    u64 t0 = osGetTime();
+    for (int p = 0; p < passes; p++) draw(&w);
+    u64 ms = osGetTime() - t0;
+    printf("golden image ok, %.3f ms per redraw of both charts\n",
+           (double)ms / passes);
+    prof_print(stdout);
+    return 0;
+}
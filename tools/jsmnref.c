@@ -0,0 +1,323 @@
+#include "jsmnref.h"
+#include "jsmn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Token ─────────────────────────────────────────────────────────────────
+static int jsoneq(const char *buf, const jsmntok_t *t, const char *s) {
+    int n = t->end - t->start;
+    if (t->type == JSMN_STRING && (int)strlen(s) == n
+        && strncmp(buf + t->start, s, n) == 0)
+        return 0;
+    return -1;
+}
+
+static void tok2str(const char *buf, const jsmntok_t *t,
+                    char *out, int maxlen) {
+    int n = t->end - t->start;
+    if (n >= maxlen) n = maxlen - 1;
+    memcpy(out, buf + t->start, n);
+    out[n] = '\0';
+}
+
+static bool is_null(const char *buf, const jsmntok_t *t) {
+    return t->type == JSMN_PRIMITIVE && t->end - t->start == 4
+        && memcmp(buf + t->start, "null", 4) == 0;
+}
+
+// Indice del primo token successivo al valore che inizia in tok[i]
+static int tok_skip(const jsmntok_t *tok, int r, int i) {
+    int j = i + 1;
+    while (j < r && tok[j].start < tok[i].end) j++;
+    return j;
+}
+
+// Token del valore di key nell'oggetto tok[obj], -1 se manca
+static int find(const char *buf, const jsmntok_t *tok, int r, int obj,
+                const char *key) {
+    for (int i = obj + 1; i < r - 1 && tok[i].start < tok[obj].end;
+         i = tok_skip(tok, r, i + 1))
+        if (jsoneq(buf, &tok[i], key) == 0) return i + 1;
+    return -1;
+}
+
+// ── Ora locale ────────────────────────────────────────────────────────────
+typedef struct {
+    const TzZone *zone;
+    s32 off;
+    int hshift;     // indice della prima ora di oggi nella serie oraria
+    int dshift;     // indice di oggi nella serie giornaliera
+} Local;
+
+static s64 floor_div(s64 a, s64 b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Le serie in GMT partono dalla mezzanotte UTC di past giorni fa: oggi
+// inizia alla prima ora UTC non prima della mezzanotte locale
+static void local_now(Local *l, s64 utc, int past) {
+    l->off = tz_offset(l->zone, utc);
+    s64 start    = (floor_div(utc, 86400) - past) * 86400;
+    s64 midnight = floor_div(utc + l->off, 86400) * 86400 - l->off;
+    l->hshift = (int)floor_div(midnight - start + 3599, 3600);
+    l->dshift = (int)(floor_div(utc + l->off, 86400)
+                      - floor_div(utc, 86400)) + past;
+}
+
+// Data (10 caratteri) dell'istante v, in ora locale se la serie e' in GMT
+static void local_date(const Local *l, const char *v, char *out) {
+    char loc[20];
+    s64 t;
+    if (l->zone && tz_parse_iso(v, (int)strlen(v), &t)) {
+        tz_format_iso(t + l->off, loc, sizeof(loc));
+        v = loc;
+    }
+    if (strlen(v) < 10) return;
+    memcpy(out, v, 10);
+    out[10] = '\0';
+}
+
+// ── Blocchi ───────────────────────────────────────────────────────────────
+static void parse_current(const char *buf, const jsmntok_t *tok, int r,
+                          int obj, WeatherData *out, Local *l, int past) {
+    char val[32];
+    int  v;
+    if ((v = find(buf, tok, r, obj, "temperature_2m")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->temp_now = strtof(val, NULL);
+    }
+    if ((v = find(buf, tok, r, obj, "relative_humidity_2m")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->humidity_now = strtof(val, NULL);
+    }
+    if ((v = find(buf, tok, r, obj, "apparent_temperature")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->feels_like_now = strtof(val, NULL);
+    }
+    if ((v = find(buf, tok, r, obj, "weather_code")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->weather_code_now = atoi(val);
+    }
+    if ((v = find(buf, tok, r, obj, "wind_speed_10m")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->wind_now = strtof(val, NULL);
+    }
+    if ((v = find(buf, tok, r, obj, "wind_direction_10m")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->wind_dir_now = atoi(val);
+    }
+    if ((v = find(buf, tok, r, obj, "surface_pressure")) >= 0
+        && !is_null(buf, &tok[v])) {
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->pressure_now = strtof(val, NULL);
+    }
+    if ((v = find(buf, tok, r, obj, "time")) >= 0
+        && tok[v].type == JSMN_STRING) {
+        char tstr[32];
+        s64  utc;
+        tok2str(buf, &tok[v], tstr, sizeof(tstr));
+        if (l->zone && tz_parse_iso(tstr, (int)strlen(tstr), &utc)) {
+            local_now(l, utc, past);
+            out->utc_offset = l->off;
+            tz_format_iso(utc + l->off, tstr, sizeof(tstr));
+        }
+        if (strlen(tstr) >= 13) out->current_hour = atoi(tstr + 11);
+        if (strlen(tstr) >= 10) {
+            memcpy(out->current_date, tstr, 10);
+            out->current_date[10] = '\0';
+        }
+    }
+}
+
+// Una serie oraria: i valori da hshift in poi, al massimo HOURLY_COUNT
+static void hourly_series(const char *buf, const jsmntok_t *tok, int r,
+                          int obj, const char *key, int shift,
+                          WeatherData *out, void *dst, bool is_int) {
+    int a = find(buf, tok, r, obj, key);
+    if (a < 0 || tok[a].type != JSMN_ARRAY) return;
+    char val[32];
+    for (int j = 0; j < tok[a].size; j++) {
+        int i = j - shift;
+        if (i < 0 || i >= HOURLY_COUNT) continue;
+        const jsmntok_t *t = &tok[a + 1 + j];
+        if (is_null(buf, t)) continue;
+        tok2str(buf, t, val, sizeof(val));
+        if (is_int) ((int*)dst)[i]   = atoi(val);
+        else        ((float*)dst)[i] = strtof(val, NULL);
+        if (i >= out->hourly_count) out->hourly_count = i + 1;
+    }
+}
+
+static void parse_hourly(const char *buf, const jsmntok_t *tok, int r,
+                         int obj, WeatherData *out, const Local *l) {
+    hourly_series(buf, tok, r, obj, "temperature_2m", l->hshift,
+                  out, out->hourly_temp, false);
+    hourly_series(buf, tok, r, obj, "precipitation", l->hshift,
+                  out, out->hourly_precip, false);
+    hourly_series(buf, tok, r, obj, "relative_humidity_2m", l->hshift,
+                  out, out->hourly_humidity, false);
+    hourly_series(buf, tok, r, obj, "weather_code", l->hshift,
+                  out, out->hourly_code, true);
+
+    // L'ora ricevuta conta anche senza valori; la prima di ogni giorno
+    // ne da' la data
+    int a = find(buf, tok, r, obj, "time");
+    if (a < 0 || tok[a].type != JSMN_ARRAY) return;
+    char val[32];
+    for (int j = 0; j < tok[a].size; j++) {
+        int i = j - l->hshift;
+        if (i < 0 || i >= HOURLY_COUNT) continue;
+        tok2str(buf, &tok[a + 1 + j], val, sizeof(val));
+        if (i % 24 == 0) local_date(l, val, out->daily_date[i / 24]);
+        else if (i >= out->hourly_count) out->hourly_count = i + 1;
+    }
+}
+
+static void daily_series(const char *buf, const jsmntok_t *tok, int r,
+                         int obj, const char *key, int shift,
+                         void *dst, bool is_int) {
+    int a = find(buf, tok, r, obj, key);
+    if (a < 0 || tok[a].type != JSMN_ARRAY) return;
+    char val[32];
+    for (int j = 0; j < tok[a].size; j++) {
+        int i = j - shift;
+        if (i < 0 || i >= FORECAST_DAYS) continue;
+        const jsmntok_t *t = &tok[a + 1 + j];
+        if (is_null(buf, t)) continue;
+        tok2str(buf, t, val, sizeof(val));
+        if (is_int) ((int*)dst)[i]   = atoi(val);
+        else        ((float*)dst)[i] = strtof(val, NULL);
+    }
+}
+
+static void parse_daily(const char *buf, const jsmntok_t *tok, int r,
+                        int obj, WeatherData *out, const Local *l) {
+    int s = l->dshift;
+    daily_series(buf, tok, r, obj, "weather_code", s, out->daily_code, true);
+    daily_series(buf, tok, r, obj, "temperature_2m_max", s,
+                 out->daily_max, false);
+    daily_series(buf, tok, r, obj, "temperature_2m_min", s,
+                 out->daily_min, false);
+    daily_series(buf, tok, r, obj, "precipitation_sum", s,
+                 out->daily_precip, false);
+    daily_series(buf, tok, r, obj, "wind_speed_10m_max", s,
+                 out->daily_wind_max, false);
+
+    int a = find(buf, tok, r, obj, "time");
+    if (a >= 0 && tok[a].type == JSMN_ARRAY)
+        for (int j = 0; j < tok[a].size; j++) {
+            int i = j - s;
+            if (i < 0 || i >= FORECAST_DAYS) continue;
+            tok2str(buf, &tok[a + 1 + j], out->daily_date[i], 12);
+        }
+
+    // Solo quello di oggi
+    a = find(buf, tok, r, obj, "uv_index_max");
+    if (a >= 0 && tok[a].type == JSMN_ARRAY && s < tok[a].size
+        && !is_null(buf, &tok[a + 1 + s])) {
+        char val[32];
+        tok2str(buf, &tok[a + 1 + s], val, sizeof(val));
+        out->uv_index = strtof(val, NULL);
+    }
+}
+
+// Minime, massime, pioggia e codice dei giorni locali dalla serie oraria
+static void days_from_hours(WeatherData *w) {
+    for (int d = 0; d < FORECAST_DAYS; d++) {
+        if ((d + 1) * 24 > w->hourly_count) break;
+        float mx = w->hourly_temp[d * 24], mn = mx, rain = 0;
+        int   code = 0;
+        for (int h = d * 24; h < (d + 1) * 24; h++) {
+            if (w->hourly_temp[h] > mx) mx = w->hourly_temp[h];
+            if (w->hourly_temp[h] < mn) mn = w->hourly_temp[h];
+            rain += w->hourly_precip[h];
+            if (w->hourly_code[h] > code) code = w->hourly_code[h];
+        }
+        w->daily_max[d]    = mx;
+        w->daily_min[d]    = mn;
+        w->daily_precip[d] = rain;
+        w->daily_code[d]   = code;
+    }
+}
+
+// ── Localita' ─────────────────────────────────────────────────────────────
+static unsigned parse_item(const char *buf, const jsmntok_t *tok, int r,
+                           int obj, WeatherData *out,
+                           const TzZone *zone, int past) {
+    Local l = { zone, 0, 24 * past, past };
+    unsigned blocks = 0;
+    int v;
+
+    // In GMT e' 0: l'offset vero viene da current.time
+    if (!zone && (v = find(buf, tok, r, obj, "utc_offset_seconds")) >= 0) {
+        char val[32];
+        tok2str(buf, &tok[v], val, sizeof(val));
+        out->utc_offset = atoi(val);
+    }
+    if ((v = find(buf, tok, r, obj, "current")) >= 0
+        && tok[v].type == JSMN_OBJECT) {
+        parse_current(buf, tok, r, v, out, &l, past);
+        blocks |= WEATHER_CURRENT;
+    }
+    if ((v = find(buf, tok, r, obj, "hourly")) >= 0
+        && tok[v].type == JSMN_OBJECT) {
+        parse_hourly(buf, tok, r, v, out, &l);
+        blocks |= WEATHER_HOURLY;
+    }
+    if ((v = find(buf, tok, r, obj, "daily")) >= 0
+        && tok[v].type == JSMN_OBJECT) {
+        parse_daily(buf, tok, r, v, out, &l);
+        blocks |= WEATHER_DAILY;
+    }
+    if (zone) days_from_hours(out);
+    out->blocks |= blocks;
+    return blocks;
+}
+
+int jsmnref_parse(const char *buf, int len, WeatherData *out, int count,
+                  const TzZone *const *zones, int past_days) {
+    jsmn_parser p;
+    jsmn_init(&p);
+    int n = jsmn_parse(&p, buf, len, NULL, 0);
+    if (n < 1) return -1;
+    jsmntok_t *tok = (jsmntok_t*)malloc(n * sizeof(jsmntok_t));
+    if (!tok) return -1;
+    jsmn_init(&p);
+    int r = jsmn_parse(&p, buf, len, tok, n);
+    if (r < 1) {
+        free(tok);
+        return -1;
+    }
+
+    int items = 0;
+    unsigned blocks = 0;
+    if (tok[0].type == JSMN_OBJECT) {
+        blocks = parse_item(buf, tok, r, 0, out, zones ? zones[0] : NULL,
+                            past_days);
+        items  = 1;
+    } else if (tok[0].type == JSMN_ARRAY) {
+        for (int i = 1; i < r && items < tok[0].size;
+             i = tok_skip(tok, r, i), items++) {
+            if (tok[i].type != JSMN_OBJECT) {
+                free(tok);
+                return -1;
+            }
+            if (items >= count) continue;
+            unsigned b = parse_item(buf, tok, r, i, &out[items],
+                                    zones ? zones[items] : NULL, past_days);
+            blocks = items ? (blocks & b) : b;
+        }
+    } else {
+        free(tok);
+        return -1;
+    }
+    free(tok);
+    return items >= count ? (int)blocks : 0;
+}
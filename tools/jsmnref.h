@@ -0,0 +1,17 @@
+#ifndef JSMNREF_H
+#define JSMNREF_H
+
+#include "weather.h"
+#include "tz.h"
+
+// Riferimento per wxparse.c: l'estrazione delle previsioni con jsmn
+// com'era prima dell'estrattore a passata singola (tokenizza tutta la
+// risposta, poi cerca le chiavi con strncmp), estesa alle risposte con
+// piu' localita' e all'ora locale delle risposte in GMT. Gli argomenti
+// sono quelli di wxp_init_many() e wxp_localize(); ritorna quello che
+// ritornerebbe wxp_finish(). Serve solo ai confronti su PC.
+
+int jsmnref_parse(const char *buf, int len, WeatherData *out, int count,
+                  const TzZone *const *zones, int past_days);
+
+#endif
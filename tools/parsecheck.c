@@ -0,0 +1,278 @@
+// Confronto su PC tra wxparse.c e il riferimento con jsmn
+// (tools/jsmnref.c) sulle risposte in tools/corpus: una localita' e
+// piu' localita' in un array, in GMT da portare in ora locale e gia' in
+// ora locale, con tutti i blocchi o solo alcuni. Ogni risposta si passa
+// a wxparse intera, un byte per volta e a pezzi di 7 byte; ogni campo
+// di WeatherData deve coincidere con quello del riferimento. Poi ogni
+// risposta troncata in PARSE_CUTS punti dev'essere rifiutata da tutti e
+// due, come le risposte con una parentesi del tipo sbagliato da
+// wxparse (il jsmn del repo non controlla il tipo di chi chiude).
+// Infine misura il tempo di un'estrazione con ciascuno.
+//
+//   parsecheck [-v]
+//
+// Con -v stampa ogni localita' confrontata.
+
+#include "wxparse.h"
+#include "jsmnref.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CORPUS      "tools/corpus/"
+#define PARSE_PAST  1       // past_days delle richieste (FORECAST_PAST)
+#define PARSE_CUTS  64
+#define PARSE_SWAPS 32
+#define MAX_LOC     6
+
+typedef struct {
+    const char *file;
+    int         count;
+    // Fuso di ogni localita': NULL se la risposta e' gia' in ora locale
+    const char *zone[MAX_LOC];
+    unsigned    blocks;     // atteso da wxp_finish()
+} Case;
+
+static const Case cases[] = {
+    { "rome_gmt.json",      1, { "Europe/Rome" },        WEATHER_ALL },
+    { "rome_current.json",  1, { "Europe/Rome" },        WEATHER_CURRENT },
+    { "tokyo_daily.json",   1, { "Asia/Tokyo" },
+      WEATHER_CURRENT | WEATHER_DAILY },
+    { "chatham_local.json", 1, { NULL },                 WEATHER_ALL },
+    { "multi_gmt.json",     6, { "Europe/Rome", "America/New_York",
+                                 "Asia/Tokyo", "Australia/Adelaide",
+                                 "America/St_Johns", "Asia/Kolkata" },
+      WEATHER_ALL },
+    { "multi_mixed.json",   2, { "Europe/Rome", NULL },  WEATHER_ALL },
+};
+
+#define CASE_COUNT  ((int)(sizeof(cases) / sizeof(cases[0])))
+
+static bool verbose;
+static int  fails;
+static int  swaps;
+
+static char *load(const char *name, int *len) {
+    char path[128];
+    snprintf(path, sizeof(path), CORPUS "%s", name);
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = (char*)malloc(n + 1);
+    if (buf && fread(buf, 1, n, f) != (size_t)n) { free(buf); buf = NULL; }
+    fclose(f);
+    if (!buf) return NULL;
+    buf[n] = '\0';
+    *len = (int)n;
+    return buf;
+}
+
+// ── Confronto campo per campo ─────────────────────────────────────────────
+static const char *where;
+
+static void diff(const char *field, int i, const char *got,
+                 const char *want) {
+    if (fails++ < 20)
+        printf("%s: %s[%d] wxparse %s, jsmn %s\n", where, field, i,
+               got, want);
+}
+
+static void cmp_f(const char *field, int i, float got, float want) {
+    char a[24], b[24];
+    if (got == want) return;
+    snprintf(a, sizeof(a), "%g", got);
+    snprintf(b, sizeof(b), "%g", want);
+    diff(field, i, a, b);
+}
+
+static void cmp_i(const char *field, int i, long got, long want) {
+    char a[24], b[24];
+    if (got == want) return;
+    snprintf(a, sizeof(a), "%ld", got);
+    snprintf(b, sizeof(b), "%ld", want);
+    diff(field, i, a, b);
+}
+
+static void cmp_s(const char *field, int i, const char *got,
+                  const char *want) {
+    if (strcmp(got, want) != 0) diff(field, i, got, want);
+}
+
+static void compare(const WeatherData *g, const WeatherData *w) {
+    cmp_f("temp_now",         0, g->temp_now,         w->temp_now);
+    cmp_f("wind_now",         0, g->wind_now,         w->wind_now);
+    cmp_i("wind_dir_now",     0, g->wind_dir_now,     w->wind_dir_now);
+    cmp_f("pressure_now",     0, g->pressure_now,     w->pressure_now);
+    cmp_f("humidity_now",     0, g->humidity_now,     w->humidity_now);
+    cmp_f("feels_like_now",   0, g->feels_like_now,   w->feels_like_now);
+    cmp_i("weather_code_now", 0, g->weather_code_now, w->weather_code_now);
+    cmp_i("current_hour",     0, g->current_hour,     w->current_hour);
+    cmp_s("current_date",     0, g->current_date,     w->current_date);
+
+    cmp_i("hourly_count", 0, g->hourly_count, w->hourly_count);
+    for (int i = 0; i < HOURLY_COUNT; i++) {
+        cmp_f("hourly_temp",     i, g->hourly_temp[i],     w->hourly_temp[i]);
+        cmp_f("hourly_precip",   i, g->hourly_precip[i],   w->hourly_precip[i]);
+        cmp_f("hourly_humidity", i, g->hourly_humidity[i],
+              w->hourly_humidity[i]);
+        cmp_i("hourly_code",     i, g->hourly_code[i],     w->hourly_code[i]);
+    }
+
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        cmp_s("daily_date",     i, g->daily_date[i],     w->daily_date[i]);
+        cmp_f("daily_max",      i, g->daily_max[i],      w->daily_max[i]);
+        cmp_f("daily_min",      i, g->daily_min[i],      w->daily_min[i]);
+        cmp_f("daily_precip",   i, g->daily_precip[i],   w->daily_precip[i]);
+        cmp_f("daily_wind_max", i, g->daily_wind_max[i], w->daily_wind_max[i]);
+        cmp_i("daily_code",     i, g->daily_code[i],     w->daily_code[i]);
+        cmp_i("daily_sunrise",  i, g->daily_sunrise[i],  w->daily_sunrise[i]);
+        cmp_i("daily_sunset",   i, g->daily_sunset[i],   w->daily_sunset[i]);
+        cmp_i("daily_light",    i, g->daily_light[i],    w->daily_light[i]);
+    }
+
+    cmp_f("uv_index",     0, g->uv_index,     w->uv_index);
+    cmp_i("utc_offset",   0, g->utc_offset,   w->utc_offset);
+    cmp_i("sunrise_hour", 0, g->sunrise_hour, w->sunrise_hour);
+    cmp_i("sunrise_min",  0, g->sunrise_min,  w->sunrise_min);
+    cmp_i("sunset_hour",  0, g->sunset_hour,  w->sunset_hour);
+    cmp_i("sunset_min",   0, g->sunset_min,   w->sunset_min);
+    cmp_i("blocks",       0, g->blocks,       w->blocks);
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        cmp_i("fetched", b, (long)g->fetched[b], (long)w->fetched[b]);
+    cmp_i("valid",        0, g->valid,        w->valid);
+}
+
+// ── Estrazione ────────────────────────────────────────────────────────────
+static WeatherData got[MAX_LOC], want[MAX_LOC];
+static const TzZone *zones[MAX_LOC];
+
+static int run_wxparse(const Case *c, const char *buf, int len, int chunk) {
+    WxParser p;
+    memset(got, 0, sizeof(got));
+    wxp_init_many(&p, got, c->count);
+    wxp_localize(&p, zones, PARSE_PAST);
+    for (int i = 0; i < len; i += chunk)
+        wxp_feed(&p, buf + i, len - i < chunk ? len - i : chunk);
+    return wxp_finish(&p);
+}
+
+static int run_jsmn(const Case *c, const char *buf, int len) {
+    memset(want, 0, sizeof(want));
+    return jsmnref_parse(buf, len, want, c->count, zones, PARSE_PAST);
+}
+
+// Posizione in "{}[]", -1 se ch non e' una parentesi
+static int bracket(char ch) {
+    switch (ch) {
+    case '{': return 0;
+    case '}': return 1;
+    case '[': return 2;
+    case ']': return 3;
+    default:  return -1;
+    }
+}
+
+static void check(const Case *c, const char *buf, int len) {
+    static const int chunks[] = { 1 << 30, 1, 7 };
+    char name[64];
+
+    for (int i = 0; i < c->count; i++)
+        zones[i] = c->zone[i] ? tz_find(c->zone[i]) : NULL;
+
+    int ref = run_jsmn(c, buf, len);
+    if (ref != (int)c->blocks) {
+        printf("%s: jsmn returned %d, expected %u\n", c->file, ref, c->blocks);
+        fails++;
+    }
+    for (int k = 0; k < 3; k++) {
+        int r = run_wxparse(c, buf, len, chunks[k]);
+        if (r != ref) {
+            printf("%s: wxparse returned %d, jsmn %d\n", c->file, r, ref);
+            fails++;
+        }
+        for (int i = 0; i < c->count; i++) {
+            snprintf(name, sizeof(name), "%s #%d (%s)", c->file, i,
+                     k == 0 ? "whole" : k == 1 ? "1-byte" : "7-byte");
+            where = name;
+            compare(&got[i], &want[i]);
+            if (verbose && k == 0)
+                printf("%-34s %s %2d:00  %3d hours  blocks %u\n", name,
+                       want[i].current_date, want[i].current_hour,
+                       want[i].hourly_count, want[i].blocks);
+        }
+    }
+
+    // Risposte troncate: incomplete per tutti e due
+    for (int n = 0; n < PARSE_CUTS; n++) {
+        int cut = (int)((long)len * n / PARSE_CUTS);
+        if (n == PARSE_CUTS - 1) cut = len - 1;
+        int a = run_wxparse(c, buf, cut, 1 << 30);
+        int b = run_jsmn(c, buf, cut);
+        if (a != -1 || b != -1) {
+            printf("%s: %d of %d bytes: wxparse %d, jsmn %d\n",
+                   c->file, cut, len, a, b);
+            fails++;
+        }
+    }
+
+    // Parentesi scambiate: '{' <-> '[' e '}' <-> ']', una per volta
+    char *bad = (char*)malloc(len);
+    if (!bad) return;
+    int brackets = 0;
+    for (int i = 0; i < len; i++)
+        brackets += bracket(buf[i]) >= 0;
+    int step = brackets / PARSE_SWAPS + 1, seen = 0;
+    for (int i = 0; i < len; i++) {
+        int k = bracket(buf[i]);
+        if (k < 0 || seen++ % step) continue;
+        memcpy(bad, buf, len);
+        bad[i] = "[]{}"[k];
+        int r = run_wxparse(c, bad, len, 1 << 30);
+        swaps++;
+        if (r != -1) {
+            printf("%s: '%c' at %d swapped: wxparse %d\n",
+                   c->file, buf[i], i, r);
+            fails++;
+        }
+    }
+    free(bad);
+}
+
+int main(int argc, char **argv) {
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    char *buf[CASE_COUNT];
+    int   len[CASE_COUNT];
+    int   locs = 0;
+    for (int i = 0; i < CASE_COUNT; i++) {
+        buf[i] = load(cases[i].file, &len[i]);
+        if (!buf[i]) return 1;
+        check(&cases[i], buf[i], len[i]);
+        locs += cases[i].count;
+    }
+    if (fails) {
+        printf("%d differences\n", fails);
+        return 1;
+    }
+
+    int passes = 200;
+    u64 t0 = osGetTime();
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < CASE_COUNT; i++)
+            run_wxparse(&cases[i], buf[i], len[i], 1 << 30);
+    u64 t1 = osGetTime();
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < CASE_COUNT; i++)
+            run_jsmn(&cases[i], buf[i], len[i]);
+    u64 t2 = osGetTime();
+
+    printf("%d responses, %d locations: wxparse = jsmn (whole, 1-byte and "
+           "7-byte chunks), %d truncated bodies and %d swapped brackets "
+           "rejected\n", CASE_COUNT, locs, CASE_COUNT * PARSE_CUTS, swaps);
+    printf("corpus parse: wxparse %.3f ms, jsmn %.3f ms\n",
+           (double)(t1 - t0) / passes, (double)(t2 - t1) / passes);
+    for (int i = 0; i < CASE_COUNT; i++) free(buf[i]);
+    return 0;
+}
@@ -0,0 +1,15 @@
+// Parte di platform.h che non puo' stare nell'intestazione: i
+// framebuffer del PC, condivisi da tutti i file che li disegnano.
+
+#include "platform.h"
+
+static u16 fbTop[400 * 240], fbBottom[320 * 240];
+
+// Come sul 3DS lo schermo e' ruotato: width e' l'altezza visibile
+u8 *gfxGetFramebuffer(gfxScreen_t screen, gfx3dSide_t side,
+                      u16 *width, u16 *height) {
+    (void)side;
+    if (width)  *width  = 240;
+    if (height) *height = (screen == GFX_TOP) ? 400 : 320;
+    return (u8*)(screen == GFX_TOP ? fbTop : fbBottom);
+}
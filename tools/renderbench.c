@@ -0,0 +1,71 @@
+// Verifica e misura di render.c su un framebuffer in memoria.
+// Confronta ogni glifo con un disegno pixel per pixel come quello della
+// console di libctru, poi riempie lo schermo superiore piu' volte e
+// stampa i glifi al millisecondo e la sezione "text" di prof.h.
+//
+//   renderbench [passate]
+
+#include "render.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define COLS  50
+#define ROWS  30
+
+static u16 fb[COLS * 8 * RENDER_FB_HEIGHT];
+static u8  font[256 * 8];
+
+// Riferimento: stesso ordine dei pixel di consoleDrawChar
+static int check_glyph(int x, int y, u8 ch, u16 fg) {
+    const u8 *rows = font + ch * 8;
+    for (int c = 0; c < 8; c++)
+        for (int r = 0; r < 8; r++) {
+            int px  = x * 8 + c;
+            int py  = y * 8 + r;
+            u16 exp = (rows[r] & (0x80 >> c)) ? fg : 0;
+            if (fb[px * RENDER_FB_HEIGHT + (RENDER_FB_HEIGHT - 1 - py)] != exp)
+                return -1;
+        }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int passes = argc > 1 ? atoi(argv[1]) : 2000;
+
+    prof_init();
+    srand(1);
+    for (int i = 0; i < (int)sizeof(font); i++) font[i] = (u8)rand();
+    render_init(font, 0, 256);
+    render_target(fb, COLS, ROWS);
+
+    // Bianco brillante = 0xFFFF in RGB565
+    char line[COLS];
+    for (int y = 0; y < ROWS; y++) {
+        for (int x = 0; x < COLS; x++) line[x] = (char)(y * COLS + x);
+        render_text(0, y, line, COLS, RC_WHITE | RC_BRIGHT);
+        for (int x = 0; x < COLS; x++)
+            if (check_glyph(x, y, (u8)line[x], 0xFFFF) != 0) {
+                printf("mismatch at cell %d,%d\n", x, y);
+                return 1;
+            }
+    }
+
+    for (int x = 0; x < COLS; x++) line[x] = (char)('A' + x % 26);
+    u64 t0 = osGetTime();
+    for (int p = 0; p < passes; p++) {
+        // Uno schermo intero di testo, come un term_flush() completo
+        u64 tp = prof_now();
+        for (int y = 0; y < ROWS; y++)
+            render_text(0, y, line, COLS, p & 15);
+        prof_end(PROF_TEXT, tp);
+    }
+    u64 ms = osGetTime() - t0;
+
+    u64 glyphs = (u64)passes * ROWS * COLS;
+    printf("%llu glyphs in %llu ms: %.0f glyphs/ms\n",
+           (unsigned long long)glyphs, (unsigned long long)ms,
+           ms ? (double)glyphs / ms : 0.0);
+    prof_print(stdout);
+    return 0;
+}
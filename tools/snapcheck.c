@@ -0,0 +1,247 @@
+// Verifica di snapshot.c su PC: codifica un WeatherData con tutti i
+// campi riempiti, lo decodifica e confronta ogni campo entro la
+// quantizzazione del formato (decimi per temperature, vento, pressione,
+// UV e pioggia fino a 10 mm; mm interi oltre; unita' per l'umidita').
+// Poi controlla che siano rifiutati gli snapshot con un byte alterato,
+// con un'altra versione e troncati, e che un salto di temperatura oltre
+// la differenza massima si recuperi nelle ore seguenti.
+//
+//   snapcheck [-v]
+//
+// Con -v stampa ogni campo confrontato.
+
+#include "platform.h"
+#include "snapshot.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool verbose;
+static int  fails;
+
+// Generatore fisso: i dati non dipendono dalla libc
+static u32 seed = 2463534242u;
+static u32 next_rand(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Valore in [lo, hi] con passo di un millesimo, non gia' quantizzato
+static float rnd(float lo, float hi) {
+    return lo + (hi - lo) * (next_rand() % 1001) / 1000.f;
+}
+
+static void sample(WeatherData *w) {
+    memset(w, 0, sizeof(*w));
+    w->temp_now         = -7.34f;
+    w->wind_now         = 23.46f;
+    w->wind_dir_now     = 247;
+    w->pressure_now     = 1013.27f;
+    w->humidity_now     = 81.4f;
+    w->feels_like_now   = -11.86f;
+    w->weather_code_now = 73;
+    w->current_hour     = 14;
+    w->uv_index         = 3.26f;
+    w->utc_offset       = 19800;            // +05:30
+    strcpy(w->current_date, "2026-10-17");
+
+    w->hourly_count = HOURLY_COUNT;
+    float t = -4.f;
+    for (int i = 0; i < HOURLY_COUNT; i++) {
+        t += rnd(-2.5f, 2.5f);
+        w->hourly_temp[i]     = t;
+        // Un'ora su tre sopra i 10 mm, dove il passo diventa 1 mm
+        w->hourly_precip[i]   = i % 3 ? rnd(0.f, 9.9f) : rnd(10.f, 160.f);
+        w->hourly_humidity[i] = rnd(0.f, 100.f);
+        w->hourly_code[i]     = (int)(next_rand() % 100);
+    }
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        snprintf(w->daily_date[i], sizeof(w->daily_date[i]),
+                 "2026-10-%02d", 17 + i);
+        w->daily_max[i]      = rnd(-5.f, 38.f);
+        w->daily_min[i]      = w->daily_max[i] - rnd(2.f, 12.f);
+        w->daily_precip[i]   = rnd(0.f, 120.f);
+        w->daily_wind_max[i] = rnd(0.f, 90.f);
+        w->daily_code[i]     = (int)(next_rand() % 100);
+    }
+
+    w->blocks = WEATHER_ALL;
+    w->fetched[0] = 1792224000;
+    w->fetched[1] = 1792220400;
+    w->fetched[2] = 1792180800;
+    w->valid = 1;
+}
+
+// ── Confronto ─────────────────────────────────────────────────────────────
+// Scarto ammesso: meta' passo, piu' l'errore di arrotondamento dei float
+static void near(const char *name, int i, float got, float want, float step) {
+    bool ok = fabsf(got - want) <= step / 2 + 1e-3f;
+    if (!ok) fails++;
+    if (verbose || !ok)
+        printf("%-16s %3d  %10.3f  ref %10.3f  %s\n",
+               name, i, got, want, ok ? "ok" : "FAIL");
+}
+
+static void same(const char *name, int i, long got, long want) {
+    bool ok = got == want;
+    if (!ok) fails++;
+    if (verbose || !ok)
+        printf("%-16s %3d  %10ld  ref %10ld  %s\n",
+               name, i, got, want, ok ? "ok" : "FAIL");
+}
+
+static void same_str(const char *name, int i, const char *got,
+                     const char *want) {
+    bool ok = strcmp(got, want) == 0;
+    if (!ok) fails++;
+    if (verbose || !ok)
+        printf("%-16s %3d  %10s  ref %10s  %s\n",
+               name, i, got, want, ok ? "ok" : "FAIL");
+}
+
+static float precip_step(float mm) {
+    return mm < 10.f ? .1f : 1.f;
+}
+
+// Alba e tramonto non sono nel formato: li ricalcola weather_sun()
+static void compare(const WeatherData *g, const WeatherData *w) {
+    near("temp_now",         0, g->temp_now,       w->temp_now,       .1f);
+    near("feels_like_now",   0, g->feels_like_now, w->feels_like_now, .1f);
+    near("wind_now",         0, g->wind_now,       w->wind_now,       .1f);
+    near("pressure_now",     0, g->pressure_now,   w->pressure_now,   .1f);
+    near("humidity_now",     0, g->humidity_now,   w->humidity_now,   1.f);
+    near("uv_index",         0, g->uv_index,       w->uv_index,       .1f);
+    same("wind_dir_now",     0, g->wind_dir_now,     w->wind_dir_now);
+    same("weather_code_now", 0, g->weather_code_now, w->weather_code_now);
+    same("current_hour",     0, g->current_hour,     w->current_hour);
+    same("utc_offset",       0, g->utc_offset,       w->utc_offset);
+    same_str("current_date", 0, g->current_date,     w->current_date);
+
+    same("hourly_count", 0, g->hourly_count, w->hourly_count);
+    for (int i = 0; i < w->hourly_count; i++) {
+        near("hourly_temp",     i, g->hourly_temp[i], w->hourly_temp[i], .1f);
+        near("hourly_precip",   i, g->hourly_precip[i], w->hourly_precip[i],
+             precip_step(w->hourly_precip[i]));
+        near("hourly_humidity", i, g->hourly_humidity[i],
+             w->hourly_humidity[i], 1.f);
+        same("hourly_code",     i, g->hourly_code[i], w->hourly_code[i]);
+    }
+
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        same_str("daily_date",   i, g->daily_date[i], w->daily_date[i]);
+        near("daily_max",        i, g->daily_max[i],  w->daily_max[i], .1f);
+        near("daily_min",        i, g->daily_min[i],  w->daily_min[i], .1f);
+        near("daily_precip",     i, g->daily_precip[i],
+             w->daily_precip[i], .1f);
+        near("daily_wind_max",   i, g->daily_wind_max[i],
+             w->daily_wind_max[i], .1f);
+        same("daily_code",       i, g->daily_code[i], w->daily_code[i]);
+    }
+
+    same("blocks", 0, g->blocks, w->blocks);
+    for (int b = 0; b < WEATHER_BLOCKS; b++)
+        same("fetched", b, (long)g->fetched[b], (long)w->fetched[b]);
+    same("valid", 0, g->valid, w->valid);
+}
+
+// ── Snapshot non validi ───────────────────────────────────────────────────
+static void reject(const char *what, const unsigned char *buf, int len) {
+    WeatherData w;
+    if (snapshot_decode(buf, len, &w) == 0) {
+        printf("%s: accepted\n", what);
+        fails++;
+    }
+}
+
+static void corrupt(const unsigned char *buf, int len) {
+    static unsigned char bad[SNAPSHOT_MAX_SIZE];
+    char what[48];
+
+    // Ogni byte, uno alla volta: li coprono CRC e intestazione
+    for (int i = 0; i < len; i++) {
+        memcpy(bad, buf, len);
+        bad[i] ^= 0xFF;
+        snprintf(what, sizeof(what), "byte %d flipped", i);
+        reject(what, bad, len);
+    }
+
+    memcpy(bad, buf, len);
+    bad[2] = SNAPSHOT_VERSION + 1;
+    reject("version + 1", bad, len);
+    bad[2] = SNAPSHOT_VERSION - 1;
+    reject("version - 1", bad, len);
+
+    for (int n = 0; n < len; n++) {
+        snprintf(what, sizeof(what), "%d of %d bytes", n, len);
+        reject(what, buf, n);
+    }
+}
+
+// ── Salto di temperatura oltre la differenza massima ──────────────────────
+static void jump(void) {
+    static WeatherData w, g;
+    static unsigned char buf[SNAPSHOT_MAX_SIZE];
+    memset(&w, 0, sizeof(w));
+    w.blocks = WEATHER_HOURLY;
+    w.hourly_count = 6;
+    float t[6] = { 2.f, 22.f, 22.f, 22.f, 22.f, 22.f };
+    memcpy(w.hourly_temp, t, sizeof(t));
+
+    int len = snapshot_encode(&w, buf, sizeof(buf));
+    if (len < 0 || snapshot_decode(buf, len, &g) != 0) {
+        printf("jump: encode/decode failed\n");
+        fails++;
+        return;
+    }
+    // 20 gradi: 12.7 subito, il resto all'ora dopo
+    near("jump",  1, g.hourly_temp[1], 14.7f, .1f);
+    for (int i = 2; i < 6; i++)
+        near("jump", i, g.hourly_temp[i], 22.f, .1f);
+}
+
+int main(int argc, char **argv) {
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    static WeatherData w, g;
+    static unsigned char buf[SNAPSHOT_MAX_SIZE];
+    sample(&w);
+    int len = snapshot_encode(&w, buf, sizeof(buf));
+    if (len < 0 || snapshot_decode(buf, len, &g) != 0) {
+        printf("full snapshot: encode/decode failed\n");
+        return 1;
+    }
+    compare(&g, &w);
+    corrupt(buf, len);
+    int full = len;
+
+    // Solo la corrente, come dopo il primo download di una citta'
+    WeatherData cur = w;
+    cur.blocks = WEATHER_CURRENT;
+    cur.hourly_count = 0;
+    memset(cur.daily_date, 0, sizeof(cur.daily_date));
+    memset(cur.daily_max,  0, sizeof(cur.daily_max));
+    memset(cur.daily_min,  0, sizeof(cur.daily_min));
+    memset(cur.daily_precip,   0, sizeof(cur.daily_precip));
+    memset(cur.daily_wind_max, 0, sizeof(cur.daily_wind_max));
+    memset(cur.daily_code, 0, sizeof(cur.daily_code));
+    cur.fetched[1] = cur.fetched[2] = 0;
+    len = snapshot_encode(&cur, buf, sizeof(buf));
+    if (len < 0 || snapshot_decode(buf, len, &g) != 0) {
+        printf("current only: encode/decode failed\n");
+        return 1;
+    }
+    compare(&g, &cur);
+
+    jump();
+
+    if (fails) {
+        printf("%d checks failed\n", fails);
+        return 1;
+    }
+    printf("snapshot ok: %d bytes with %d hours (limit %d), %d current "
+           "only\n", full, HOURLY_COUNT, SNAPSHOT_LIMIT, len);
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Verifica di sun.c su PC contro una tabella di riferimento.
+// I valori sono le formule NOAA in doppia precisione, con la posizione
+// del sole ricalcolata all'istante dell'evento fino a convergenza, e
+// l'offset del fuso di ogni data preso dal tzdata di sistema. Coprono
+// equinozi, solstizi e due date qualsiasi per citta' di ogni
+// latitudine, compresi il sole di mezzanotte e la notte polare. Alba e
+// tramonto devono coincidere entro SUN_TOLERANCE minuti; misura anche
+// il tempo di un calcolo.
+//
+//   suncheck [-v]
+//
+// Con -v stampa ogni riga della tabella con lo scarto.
+
+#include "sun.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUN_TOLERANCE  1
+
+typedef struct {
+    const char *name;
+    float       lat, lon;
+    int         y, m, d;
+    s32         offset;
+    int         status;
+    s16         rise, set;
+} SunRef;
+
+static const SunRef refs[] = {
+    { "London",       51.5074,   -0.1278, 2026,  3, 20,      0, SUN_NORMAL,       363,     1094 },
+    { "London",       51.5074,   -0.1278, 2026,  6, 21,   3600, SUN_NORMAL,       283,     1282 },
+    { "London",       51.5074,   -0.1278, 2026,  9, 23,   3600, SUN_NORMAL,       408,     1137 },
+    { "London",       51.5074,   -0.1278, 2026, 12, 21,      0, SUN_NORMAL,       484,      953 },
+    { "London",       51.5074,   -0.1278, 2026, 10, 18,   3600, SUN_NORMAL,       449,     1081 },
+    { "London",       51.5074,   -0.1278, 2027,  2,  5,      0, SUN_NORMAL,       453,     1017 },
+    { "Rome",         41.9028,   12.4964, 2026,  3, 20,   3600, SUN_NORMAL,       374,     1102 },
+    { "Rome",         41.9028,   12.4964, 2026,  6, 21,   7200, SUN_NORMAL,       335,     1249 },
+    { "Rome",         41.9028,   12.4964, 2026,  9, 23,   7200, SUN_NORMAL,       418,     1146 },
+    { "Rome",         41.9028,   12.4964, 2026, 12, 21,   3600, SUN_NORMAL,       454,     1002 },
+    { "Rome",         41.9028,   12.4964, 2026, 10, 18,   7200, SUN_NORMAL,       446,     1104 },
+    { "Rome",         41.9028,   12.4964, 2027,  2,  5,   3600, SUN_NORMAL,       439,     1050 },
+    { "New York",     40.7128,  -74.0060, 2026,  3, 20, -14400, SUN_NORMAL,       419,     1148 },
+    { "New York",     40.7128,  -74.0060, 2026,  6, 21, -14400, SUN_NORMAL,       325,     1231 },
+    { "New York",     40.7128,  -74.0060, 2026,  9, 23, -14400, SUN_NORMAL,       405,     1131 },
+    { "New York",     40.7128,  -74.0060, 2026, 12, 21, -18000, SUN_NORMAL,       437,      992 },
+    { "New York",     40.7128,  -74.0060, 2026, 10, 18, -14400, SUN_NORMAL,       431,     1091 },
+    { "New York",     40.7128,  -74.0060, 2027,  2,  5, -18000, SUN_NORMAL,       422,     1038 },
+    { "Sydney",      -33.8688,  151.2093, 2026,  3, 20,  39600, SUN_NORMAL,       418,     1147 },
+    { "Sydney",      -33.8688,  151.2093, 2026,  6, 21,  36000, SUN_NORMAL,       420,     1014 },
+    { "Sydney",      -33.8688,  151.2093, 2026,  9, 23,  36000, SUN_NORMAL,       344,     1072 },
+    { "Sydney",      -33.8688,  151.2093, 2026, 12, 21,  39600, SUN_NORMAL,       341,     1205 },
+    { "Sydney",      -33.8688,  151.2093, 2026, 10, 18,  39600, SUN_NORMAL,       371,     1151 },
+    { "Sydney",      -33.8688,  151.2093, 2027,  2,  5,  39600, SUN_NORMAL,       380,     1198 },
+    { "Tokyo",        35.6762,  139.6503, 2026,  3, 20,  32400, SUN_NORMAL,       346,     1073 },
+    { "Tokyo",        35.6762,  139.6503, 2026,  6, 21,  32400, SUN_NORMAL,       266,     1140 },
+    { "Tokyo",        35.6762,  139.6503, 2026,  9, 23,  32400, SUN_NORMAL,       330,     1058 },
+    { "Tokyo",        35.6762,  139.6503, 2026, 12, 21,  32400, SUN_NORMAL,       407,      992 },
+    { "Tokyo",        35.6762,  139.6503, 2026, 10, 18,  32400, SUN_NORMAL,       350,     1023 },
+    { "Tokyo",        35.6762,  139.6503, 2027,  2,  5,  32400, SUN_NORMAL,       399,     1032 },
+    { "Quito",        -0.1807,  -78.4678, 2026,  3, 20, -18000, SUN_NORMAL,       378,     1104 },
+    { "Quito",        -0.1807,  -78.4678, 2026,  6, 21, -18000, SUN_NORMAL,       372,     1099 },
+    { "Quito",        -0.1807,  -78.4678, 2026,  9, 23, -18000, SUN_NORMAL,       363,     1089 },
+    { "Quito",        -0.1807,  -78.4678, 2026, 12, 21, -18000, SUN_NORMAL,       368,     1096 },
+    { "Quito",        -0.1807,  -78.4678, 2026, 10, 18, -18000, SUN_NORMAL,       356,     1082 },
+    { "Quito",        -0.1807,  -78.4678, 2027,  2,  5, -18000, SUN_NORMAL,       384,     1112 },
+    { "Cape Town",   -33.9249,   18.4241, 2026,  3, 20,   7200, SUN_NORMAL,       409,     1138 },
+    { "Cape Town",   -33.9249,   18.4241, 2026,  6, 21,   7200, SUN_NORMAL,       471,     1065 },
+    { "Cape Town",   -33.9249,   18.4241, 2026,  9, 23,   7200, SUN_NORMAL,       395,     1123 },
+    { "Cape Town",   -33.9249,   18.4241, 2026, 12, 21,   7200, SUN_NORMAL,       332,     1197 },
+    { "Cape Town",   -33.9249,   18.4241, 2026, 10, 18,   7200, SUN_NORMAL,       361,     1142 },
+    { "Cape Town",   -33.9249,   18.4241, 2027,  2,  5,   7200, SUN_NORMAL,       371,     1189 },
+    { "Reykjavik",    64.1466,  -21.9426, 2026,  3, 20,      0, SUN_NORMAL,       449,     1183 },
+    { "Reykjavik",    64.1466,  -21.9426, 2026,  6, 21,      0, SUN_NORMAL,       175,        4 },
+    { "Reykjavik",    64.1466,  -21.9426, 2026,  9, 23,      0, SUN_NORMAL,       434,     1165 },
+    { "Reykjavik",    64.1466,  -21.9426, 2026, 12, 21,      0, SUN_NORMAL,       682,      929 },
+    { "Reykjavik",    64.1466,  -21.9426, 2026, 10, 18,      0, SUN_NORMAL,       507,     1077 },
+    { "Reykjavik",    64.1466,  -21.9426, 2027,  2,  5,      0, SUN_NORMAL,       596,     1048 },
+    { "Anchorage",    61.2181, -149.9003, 2026,  3, 20, -28800, SUN_NORMAL,       480,     1215 },
+    { "Anchorage",    61.2181, -149.9003, 2026,  6, 21, -28800, SUN_NORMAL,       260,     1423 },
+    { "Anchorage",    61.2181, -149.9003, 2026,  9, 23, -28800, SUN_NORMAL,       467,     1195 },
+    { "Anchorage",    61.2181, -149.9003, 2026, 12, 21, -32400, SUN_NORMAL,       614,      941 },
+    { "Anchorage",    61.2181, -149.9003, 2026, 10, 18, -28800, SUN_NORMAL,       531,     1118 },
+    { "Anchorage",    61.2181, -149.9003, 2027,  2,  5, -32400, SUN_NORMAL,       550,     1039 },
+    { "Honolulu",     21.3069, -157.8583, 2026,  3, 20, -36000, SUN_NORMAL,       395,     1123 },
+    { "Honolulu",     21.3069, -157.8583, 2026,  6, 21, -36000, SUN_NORMAL,       350,     1156 },
+    { "Honolulu",     21.3069, -157.8583, 2026,  9, 23, -36000, SUN_NORMAL,       381,     1106 },
+    { "Honolulu",     21.3069, -157.8583, 2026, 12, 21, -36000, SUN_NORMAL,       425,     1075 },
+    { "Honolulu",     21.3069, -157.8583, 2026, 10, 18, -36000, SUN_NORMAL,       388,     1084 },
+    { "Honolulu",     21.3069, -157.8583, 2027,  2,  5, -36000, SUN_NORMAL,       427,     1104 },
+    { "Auckland",    -36.8485,  174.7633, 2026,  3, 20,  46800, SUN_NORMAL,       443,     1173 },
+    { "Auckland",    -36.8485,  174.7633, 2026,  6, 21,  43200, SUN_NORMAL,       454,     1032 },
+    { "Auckland",    -36.8485,  174.7633, 2026,  9, 23,  43200, SUN_NORMAL,       370,     1098 },
+    { "Auckland",    -36.8485,  174.7633, 2026, 12, 21,  46800, SUN_NORMAL,       358,     1240 },
+    { "Auckland",    -36.8485,  174.7633, 2026, 10, 18,  46800, SUN_NORMAL,       393,     1180 },
+    { "Auckland",    -36.8485,  174.7633, 2027,  2,  5,  46800, SUN_NORMAL,       400,     1229 },
+    { "Kiritimati",    1.8721, -157.4278, 2026,  3, 20,  50400, SUN_NORMAL,       394,     1121 },
+    { "Kiritimati",    1.8721, -157.4278, 2026,  6, 21,  50400, SUN_NORMAL,       384,     1118 },
+    { "Kiritimati",    1.8721, -157.4278, 2026,  9, 23,  50400, SUN_NORMAL,       379,     1106 },
+    { "Kiritimati",    1.8721, -157.4278, 2026, 12, 21,  50400, SUN_NORMAL,       387,     1108 },
+    { "Kiritimati",    1.8721, -157.4278, 2026, 10, 18,  50400, SUN_NORMAL,       373,     1097 },
+    { "Kiritimati",    1.8721, -157.4278, 2027,  2,  5,  50400, SUN_NORMAL,       402,     1125 },
+    { "Tromso",       69.6492,   18.9553, 2026,  3, 20,   3600, SUN_NORMAL,       344,     1082 },
+    { "Tromso",       69.6492,   18.9553, 2026,  6, 21,   7200, SUN_POLAR_DAY,   SUN_NONE, SUN_NONE },
+    { "Tromso",       69.6492,   18.9553, 2026,  9, 23,   7200, SUN_NORMAL,       388,     1123 },
+    { "Tromso",       69.6492,   18.9553, 2026, 12, 21,   3600, SUN_POLAR_NIGHT, SUN_NONE, SUN_NONE },
+    { "Tromso",       69.6492,   18.9553, 2026, 10, 18,   7200, SUN_NORMAL,       487,     1010 },
+    { "Tromso",       69.6492,   18.9553, 2027,  2,  5,   3600, SUN_NORMAL,       545,      893 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2026,  3, 20, -10800, SUN_NORMAL,       455,     1186 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2026,  6, 21, -10800, SUN_NORMAL,       599,     1031 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2026,  9, 23, -10800, SUN_NORMAL,       439,     1173 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2026, 12, 21, -10800, SUN_NORMAL,       291,     1331 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2026, 10, 18, -10800, SUN_NORMAL,       376,     1222 },
+    { "Ushuaia",     -54.8019,  -68.3030, 2027,  2,  5, -10800, SUN_NORMAL,       365,     1288 },
+};
+
+#define REF_COUNT  ((int)(sizeof(refs) / sizeof(refs[0])))
+
+// Scarto in minuti tra due orari sul quadrante di 24 ore
+static int diff_min(int a, int b) {
+    int d = abs(a - b) % 1440;
+    return d > 720 ? 1440 - d : d;
+}
+
+int main(int argc, char **argv) {
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    int  fails = 0, worst = 0;
+
+    for (int i = 0; i < REF_COUNT; i++) {
+        const SunRef *r = &refs[i];
+        SunDay s;
+        int st = sun_day(r->lat, r->lon, r->y, r->m, r->d, r->offset, &s);
+        int err = 0;
+        bool ok = st == r->status;
+        if (ok && st == SUN_NORMAL) {
+            int dr = diff_min(s.rise, r->rise);
+            int ds = diff_min(s.set,  r->set);
+            err = dr > ds ? dr : ds;
+            ok  = err <= SUN_TOLERANCE;
+            if (err > worst) worst = err;
+        }
+        if (!ok) fails++;
+        if (verbose || !ok)
+            printf("%-11s %04d-%02d-%02d  %5d %5d  ref %5d %5d  %s\n",
+                   r->name, r->y, r->m, r->d, s.rise, s.set,
+                   r->rise, r->set, ok ? "ok" : "FAIL");
+    }
+    if (fails) {
+        printf("%d of %d days off by more than %d min\n",
+               fails, REF_COUNT, SUN_TOLERANCE);
+        return 1;
+    }
+
+    int passes = 20000;
+    u64 t0 = osGetTime();
+    volatile int sink = 0;
+    for (int p = 0; p < passes; p++) {
+        SunDay s;
+        const SunRef *r = &refs[p % REF_COUNT];
+        sun_day(r->lat, r->lon, r->y, r->m, r->d, r->offset, &s);
+        sink += s.rise;
+    }
+    u64 ms = osGetTime() - t0;
+    printf("%d days ok (max error %d min), %.2f us per day\n",
+           REF_COUNT, worst, (double)ms * 1000.0 / passes);
+    return 0;
+}
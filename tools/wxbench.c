@@ -0,0 +1,407 @@
+// Benchmark su PC dei percorsi caldi: estrazione JSON delle previsioni e
+// del geocoding (dalle risposte registrate in tools/bench), jsmn, lista
+// citta', stringhe tradotte, formattatori e disegno di una schermata sul
+// modello a celle. Per ogni caso riporta ns per operazione, byte e
+// allocazioni per operazione e picco di heap; con -o scrive un CSV da
+// confrontare con -c tra due commit.
+//
+//   wxbench [-d dir] [-t ms] [-o out.csv] [-c base.csv] [caso...]
+//
+//   -d  cartella delle risposte registrate (default: tools/bench)
+//   -t  durata minima di ogni caso (default: 300 ms)
+//   -o  scrive i risultati in CSV
+//   -c  confronta con il CSV di un'esecuzione precedente
+//
+// Le allocazioni contano anche quelle interne della libc, come i buffer
+// di fopen: malloc & co. sono ridefiniti qui sopra quelli di glibc, come
+// farebbe una libreria in LD_PRELOAD.
+
+#include "weather.h"
+#include "wxparse.h"
+#include "jsmn.h"
+#include "cities.h"
+#include "lang.h"
+#include "wxfmt.h"
+#include "snapshot.h"
+#include "term.h"
+#include "vlist.h"
+#include "transport.h"
+#include "prof.h"
+#include "ansi.h"
+#include <dirent.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ── Heap ──────────────────────────────────────────────────────────────────
+// malloc, free, calloc e realloc definiti nel programma sostituiscono
+// quelli di glibc per tutti, libc compresa, e passano all'allocatore
+// originale (__libc_*). La dimensione dei blocchi e' quella che
+// riporta malloc_usable_size(), quindi vale anche per i blocchi di
+// memalign & co. che non passano di qui.
+void *__libc_malloc(size_t n);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t n);
+void  __libc_free(void *p);
+
+static size_t heapNow, heapPeak, heapBytes, heapCount;
+
+static void heap_add(void *p) {
+    size_t n = malloc_usable_size(p);
+    heapNow   += n;
+    heapBytes += n;
+    heapCount++;
+    if (heapNow > heapPeak) heapPeak = heapNow;
+}
+
+void *malloc(size_t n) {
+    void *p = __libc_malloc(n);
+    if (p) heap_add(p);
+    return p;
+}
+
+void free(void *p) {
+    if (!p) return;
+    heapNow -= malloc_usable_size(p);
+    __libc_free(p);
+}
+
+void *calloc(size_t n, size_t size) {
+    void *p = __libc_calloc(n, size);
+    if (p) heap_add(p);
+    return p;
+}
+
+void *realloc(void *q, size_t n) {
+    size_t old = q ? malloc_usable_size(q) : 0;
+    void *p = __libc_realloc(q, n);
+    if (!p) return NULL;
+    heapNow -= old;
+    heap_add(p);
+    return p;
+}
+
+// ── Dati ──────────────────────────────────────────────────────────────────
+static char       *forecastBody, *geocodeBody;
+static size_t      forecastLen,   geocodeLen;
+static WeatherData data;
+static WxLines     lines;
+static jsmntok_t   tokens[2048];
+static City        cities[MAX_CITIES];
+
+static PrintConsole topCon, botCon;
+static u8           font[256 * 8];
+static VList        view;
+
+static char *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc(n + 1);
+    if (buf && fread(buf, 1, n, f) == (size_t)n) {
+        buf[n] = '\0';
+        *len   = n;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+// Le risposte registrate hanno il nome dell'hash dell'URL: si
+// riconoscono dal contenuto
+static int load_bodies(const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) { perror(dir); return -1; }
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        if (!strstr(e->d_name, ".json")) continue;
+        char path[512];
+        size_t len = 0;
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        char *body = read_file(path, &len);
+        if (!body) continue;
+        if (strstr(body, "\"results\"") && !geocodeBody) {
+            geocodeBody = body; geocodeLen = len;
+        } else if (strstr(body, "\"hourly\"") && !forecastBody) {
+            forecastBody = body; forecastLen = len;
+        } else {
+            free(body);
+        }
+    }
+    closedir(d);
+    if (!forecastBody || !geocodeBody) {
+        fprintf(stderr, "%s: forecast or geocoding response missing\n", dir);
+        return -1;
+    }
+    return 0;
+}
+
+// ── Casi ──────────────────────────────────────────────────────────────────
+// Un caso che fallisce misurerebbe un altro percorso (per esempio un
+// URL cambiato che non trova piu' la sua risposta registrata)
+static const char *benchDir;
+
+static void fail(const char *name, int ret) {
+    fprintf(stderr, "%s: failed with %d; is its response in %s?\n",
+            name, ret, benchDir);
+    exit(1);
+}
+
+static void bench_wxparse(void) {
+    static const TzZone *zone;
+    WxParser p;
+    if (!zone) zone = tz_find("Europe/Rome");
+    wxp_init(&p, &data);
+    wxp_localize(&p, &zone, 1);
+    for (size_t off = 0; off < forecastLen; off += 2048) {
+        size_t n = forecastLen - off < 2048 ? forecastLen - off : 2048;
+        wxp_feed(&p, forecastBody + off, n);
+    }
+    if (wxp_finish(&p) != WXP_ALL) fail("wxparse", -1);
+}
+
+static void bench_jsmn(void) {
+    jsmn_parser p;
+    jsmn_init(&p);
+    jsmn_parse(&p, geocodeBody, geocodeLen, tokens, 2048);
+}
+
+static void bench_fetch(void) {
+    WeatherData w;
+    int ret = weather_fetch(45.0f, 10.8f, "Europe/Rome", &w);
+    if (ret != 0) fail("fetch", ret);
+}
+
+static void bench_geocode(void) {
+    float lat, lon;
+    char name[48], tz[40];
+    int ret = weather_geocode("pegognaga", &lat, &lon, name, tz);
+    if (ret != 0) fail("geocode", ret);
+}
+
+static void bench_cities(void) {
+    int n = 0;
+    cities_save(cities, MAX_CITIES);
+    cities_load(cities, &n);
+}
+
+static void bench_lang(void) {
+    size_t sum = 0;
+    for (int l = 0; l < LANG_COUNT; l++) {
+        lang_set((LangID)l);
+        for (int k = 0; k < STR_COUNT; k++) sum += lang_get((StrKey)k)[0];
+    }
+    if (sum == 0) puts("");
+}
+
+static void bench_wxfmt(void) {
+    wxfmt_build(&data, &lines);
+}
+
+static void bench_snapshot(void) {
+    unsigned char buf[SNAPSHOT_MAX_SIZE];
+    WeatherData w;
+    int n = snapshot_encode(&data, buf, sizeof(buf));
+    snapshot_decode(buf, n, &w);
+}
+
+static void hour_row(void *user, int i, bool sel) {
+    (void)user;
+    (void)sel;
+    term_printf("%s", lines.hourly[i]);
+}
+
+// Come draw_hourly(): intestazione, 20 righe della lista, piede
+static void draw_screen(void) {
+    term_select(&topCon);
+    term_clear();
+    term_printf(C_CYN C_BLD "================================\n" C_RST);
+    term_printf(C_YLW C_BLD " %s\n" C_RST, lang_get(STR_HOURLY_TITLE));
+    term_printf(C_WHT " %s\n" C_RST, "Pegognaga");
+    term_printf(C_CYN "================================\n" C_RST);
+    term_printf(C_CYN " Day Hour Temp   Rain  Hum  Weather\n" C_RST);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    vlist_draw(&view, -1, hour_row, NULL);
+    term_printf(C_CYN "--------------------------------\n" C_RST);
+    term_printf(C_WHT " UP/DOWN: scroll  LEFT/RIGHT: day  B: back\n" C_RST);
+}
+
+// Cambio pagina: quasi tutte le celle della lista sono diverse
+static void bench_screen(void) {
+    view.top = view.top ? 0 : view.rows;
+    draw_screen();
+    term_flush();
+}
+
+// Scorrimento di una riga: passa solo dal confronto delle celle
+static void bench_scroll(void) {
+    static int dir = 1;
+    if (!vlist_scroll(&view, dir)) {
+        dir = -dir;
+        vlist_scroll(&view, dir);
+    }
+    draw_screen();
+    term_flush();
+}
+
+typedef struct {
+    const char *name;
+    void      (*fn)(void);
+} Case;
+
+static const Case cases[] = {
+    { "wxparse",  bench_wxparse  },
+    { "jsmn",     bench_jsmn     },
+    { "fetch",    bench_fetch    },
+    { "geocode",  bench_geocode  },
+    { "cities",   bench_cities   },
+    { "lang",     bench_lang     },
+    { "wxfmt",    bench_wxfmt    },
+    { "snapshot", bench_snapshot },
+    { "screen",   bench_screen   },
+    { "scroll",   bench_scroll   },
+};
+#define CASE_COUNT  (int)(sizeof(cases) / sizeof(cases[0]))
+
+typedef struct {
+    u64    iters;
+    double ns, bytes, allocs;
+    size_t peak;
+} BenchResult;
+
+static void run(const Case *c, u32 minMs, BenchResult *r) {
+    c->fn();    // riscaldamento
+    size_t base = heapNow;
+    heapPeak  = heapNow;
+    heapBytes = heapCount = 0;
+
+    u64 iters = 0, batch = 1;
+    u64 t0 = svcGetSystemTick(), elapsed = 0;
+    while (elapsed < (u64)minMs * 1000000ULL) {
+        for (u64 i = 0; i < batch; i++) c->fn();
+        iters  += batch;
+        batch  *= 2;
+        elapsed = svcGetSystemTick() - t0;
+    }
+    r->iters  = iters;
+    r->ns     = (double)elapsed / iters;
+    r->bytes  = (double)heapBytes / iters;
+    r->allocs = (double)heapCount / iters;
+    r->peak   = heapPeak - base;
+}
+
+// ── Confronto ─────────────────────────────────────────────────────────────
+typedef struct {
+    char   name[32];
+    double ns, bytes;
+} Baseline;
+
+static int load_baseline(const char *path, Baseline *b, int max) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+    char line[256];
+    int  n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        unsigned long long it;
+        if (sscanf(line, "%31[^,],%llu,%lf,%lf", b[n].name, &it,
+                   &b[n].ns, &b[n].bytes) == 4) n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static const Baseline *find_baseline(const Baseline *b, int n,
+                                     const char *name) {
+    for (int i = 0; i < n; i++)
+        if (strcmp(b[i].name, name) == 0) return &b[i];
+    return NULL;
+}
+
+static bool selected(int argc, char **argv, const char *name) {
+    if (optind >= argc) return true;
+    for (int i = optind; i < argc; i++)
+        if (strcmp(argv[i], name) == 0) return true;
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = "tools/bench", *out = NULL, *cmp = NULL;
+    u32 minMs = 300;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:t:o:c:")) != -1) {
+        switch (opt) {
+        case 'd': dir   = optarg;               break;
+        case 't': minMs = (u32)atoi(optarg);    break;
+        case 'o': out   = optarg;               break;
+        case 'c': cmp   = optarg;               break;
+        default:
+            fprintf(stderr, "usage: wxbench [-d dir] [-t ms] [-o out.csv]"
+                            " [-c base.csv] [case...]\n");
+            return 2;
+        }
+    }
+
+    prof_init();
+    weather_init();
+    benchDir = dir;
+    if (load_bodies(dir) < 0) return 1;
+    transport_file_dir(dir, false);
+
+    bench_wxparse();
+    for (int i = 0; i < MAX_CITIES; i++) {
+        snprintf(cities[i].name, sizeof(cities[i].name), "City %d", i);
+        cities[i].lat = 45.f + i * 0.37f;
+        cities[i].lon = 10.f - i * 0.21f;
+        snprintf(cities[i].timezone, sizeof(cities[i].timezone),
+                 "Europe/Rome");
+    }
+
+    for (int i = 0; i < (int)sizeof(font); i++) font[i] = (u8)(i * 37);
+    topCon = (PrintConsole){ { font, 0, 256 }, 50, 30 };
+    botCon = (PrintConsole){ { font, 0, 256 }, 40, 30 };
+    term_init(&topCon, &botCon);
+    wxfmt_build(&data, &lines);
+    vlist_init(&view, 20, 1);
+    vlist_set_count(&view, data.hourly_count);
+
+    Baseline base[CASE_COUNT];
+    int nbase = cmp ? load_baseline(cmp, base, CASE_COUNT) : 0;
+    if (nbase < 0) return 1;
+
+    FILE *csv = NULL;
+    if (out) {
+        csv = fopen(out, "w");
+        if (!csv) { perror(out); return 1; }
+        fprintf(csv, "case,iters,ns_per_op,bytes_per_op,allocs_per_op,"
+                     "peak_bytes\n");
+    }
+
+    printf("%-9s %12s %10s %9s %9s%s\n", "case", "ns/op", "B/op",
+           "allocs/op", "peak B", cmp ? "   ns delta  B delta" : "");
+    for (int i = 0; i < CASE_COUNT; i++) {
+        const Case *c = &cases[i];
+        if (!selected(argc, argv, c->name)) continue;
+        BenchResult r;
+        run(c, minMs, &r);
+        printf("%-9s %12.1f %10.0f %9.2f %9zu", c->name, r.ns, r.bytes,
+               r.allocs, r.peak);
+        const Baseline *b = find_baseline(base, nbase, c->name);
+        if (b && b->ns > 0)
+            printf("   %+8.1f%% %+8.0f", (r.ns / b->ns - 1.0) * 100.0,
+                   r.bytes - b->bytes);
+        printf("\n");
+        if (csv)
+            fprintf(csv, "%s,%llu,%.1f,%.1f,%.3f,%zu\n", c->name,
+                    (unsigned long long)r.iters, r.ns, r.bytes, r.allocs,
+                    r.peak);
+    }
+    if (csv) fclose(csv);
+    remove(CITIES_FILE);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Driver da riga di comando per la logica di rete e parsing su PC Linux.
+// Esegue weather_fetch()/weather_fetch_many()/weather_geocode() su un
+// trasporto host e stampa
+// risultato e tempi (anche per sezione, vedi prof.h), da lanciare anche
+// sotto perf/valgrind.
+//
+//   wxhost [-d dir] [-p porta [-r]] [-l ms] [-k ms] [-n volte] [-b chd]
+//          fetch LAT LON TIMEZONE | many LAT LON TIMEZONE... | geocode NOME
+//
+//   -d  cartella delle risposte registrate (default: responses)
+//   -p  usa il server HTTP in loopback su 127.0.0.1:porta
+//   -r  con -p, salva le risposte in -d per usarle poi senza server
+//   -l  latenza prima degli header, -k latenza per KB di corpo
+//   -n  ripete la richiesta n volte
+//   -b  blocchi di fetch: c corrente, h oraria, d giornaliera (default tutti)
+
+#include "weather.h"
+#include "transport.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void print_weather(const WeatherData *w) {
+    printf("now  %.1fC feels %.1fC code %d (%s) wind %.1f km/h %d deg\n",
+           w->temp_now, w->feels_like_now, w->weather_code_now,
+           weather_code_desc(w->weather_code_now),
+           w->wind_now, w->wind_dir_now);
+    printf("     humidity %.0f%% pressure %.1f hPa hour %d uv %.1f "
+           "sun %02d:%02d-%02d:%02d\n",
+           w->humidity_now, w->pressure_now, w->current_hour, w->uv_index,
+           w->sunrise_hour, w->sunrise_min, w->sunset_hour, w->sunset_min);
+    time_t now = time(NULL);
+    printf("     blocks %s%s%s age %ld/%ld/%ld s date %s\n",
+           (w->blocks & WEATHER_CURRENT) ? "c" : "-",
+           (w->blocks & WEATHER_HOURLY)  ? "h" : "-",
+           (w->blocks & WEATHER_DAILY)   ? "d" : "-",
+           weather_age(w, WEATHER_CURRENT, now),
+           weather_age(w, WEATHER_HOURLY, now),
+           weather_age(w, WEATHER_DAILY, now), w->current_date);
+    for (int i = 0; i < w->hourly_count; i++)
+        printf("h%03d %5.1fC %4.1fmm %3.0f%% %d\n", i, w->hourly_temp[i],
+               w->hourly_precip[i], w->hourly_humidity[i], w->hourly_code[i]);
+    for (int i = 0; i < FORECAST_DAYS; i++)
+        printf("%-10s %5.1f/%5.1fC %4.1fmm %4.1f km/h %d\n",
+               w->daily_date[i], w->daily_max[i], w->daily_min[i],
+               w->daily_precip[i], w->daily_wind_max[i], w->daily_code[i]);
+}
+
+static int usage(void) {
+    fprintf(stderr,
+        "usage: wxhost [-d dir] [-p port [-r]] [-l ms] [-k ms] [-n count]\n"
+        "              [-b chd]\n"
+        "              fetch LAT LON TIMEZONE | many LAT LON TIMEZONE...\n"
+        "              | geocode NAME\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = "responses";
+    int  port = 0, repeat = 1, opt;
+    unsigned blocks = WEATHER_ALL;
+    bool record = false;
+    u32  first = 0, perkb = 0;
+
+    while ((opt = getopt(argc, argv, "d:p:rl:k:n:b:")) != -1) {
+        switch (opt) {
+        case 'd': dir    = optarg;                      break;
+        case 'p': port   = atoi(optarg);                break;
+        case 'r': record = true;                        break;
+        case 'l': first  = (u32)strtoul(optarg, NULL, 10); break;
+        case 'k': perkb  = (u32)strtoul(optarg, NULL, 10); break;
+        case 'n': repeat = atoi(optarg);                break;
+        case 'b':
+            blocks = (strchr(optarg, 'c') ? WEATHER_CURRENT : 0)
+                   | (strchr(optarg, 'h') ? WEATHER_HOURLY  : 0)
+                   | (strchr(optarg, 'd') ? WEATHER_DAILY   : 0);
+            break;
+        default:  return usage();
+        }
+    }
+    if (optind >= argc) return usage();
+
+    prof_init();
+    weather_init();
+    transport_file_dir(dir, record);
+    transport_latency(first, perkb);
+    if (port > 0) {
+        transport_loopback_port(port);
+        transport_set(&transport_loopback);
+    }
+
+    const char *cmd = argv[optind];
+    int ret = -1;
+    u64 t0 = osGetTime();
+
+    if (strcmp(cmd, "fetch") == 0 && argc - optind == 4) {
+        WeatherData w;
+        City c;
+        memset(&c, 0, sizeof(c));
+        c.lat = strtof(argv[optind + 1], NULL);
+        c.lon = strtof(argv[optind + 2], NULL);
+        snprintf(c.timezone, sizeof(c.timezone), "%s", argv[optind + 3]);
+        for (int i = 0; i < repeat; i++)
+            ret = weather_fetch_blocks(&c, blocks, &w, NULL);
+        if (ret == 0) print_weather(&w);
+    } else if (strcmp(cmd, "many") == 0 && argc - optind >= 4
+               && (argc - optind - 1) % 3 == 0) {
+        static City        list[MAX_CITIES];
+        static WeatherData w[MAX_CITIES];
+        int n = 0;
+        for (int i = optind + 1; i + 2 < argc && n < MAX_CITIES; i += 3, n++) {
+            snprintf(list[n].name, sizeof(list[n].name), "%d", n);
+            list[n].lat = strtof(argv[i], NULL);
+            list[n].lon = strtof(argv[i + 1], NULL);
+            snprintf(list[n].timezone, sizeof(list[n].timezone), "%s",
+                     argv[i + 2]);
+        }
+        for (int i = 0; i < repeat; i++)
+            ret = weather_fetch_many(list, n, w);
+        for (int i = 0; i < n; i++) {
+            printf("-- %.4f %.4f %s valid %d\n", list[i].lat, list[i].lon,
+                   list[i].timezone, w[i].valid);
+            if (w[i].valid) print_weather(&w[i]);
+        }
+    } else if (strcmp(cmd, "geocode") == 0 && argc - optind == 2) {
+        float lat = 0, lon = 0;
+        char name[48] = "", tz[40] = "";
+        for (int i = 0; i < repeat; i++)
+            ret = weather_geocode(argv[optind + 1], &lat, &lon, name, tz);
+        if (ret == 0) printf("%s %.4f %.4f %s\n", name, lat, lon, tz);
+    } else {
+        return usage();
+    }
+
+    u64 ms = osGetTime() - t0;
+    NetStats ns;
+    weather_net_stats(&ns);
+    fprintf(stderr, "%s: ret=%d %d run(s) %llu ms, %u req %u keep-alive "
+            "eligible\n", transport_get()->name, ret, repeat,
+            (unsigned long long)ms, ns.requests, ns.keepalive);
+    fprintf(stderr, "headers: %u ms new (%u), %u ms keep-alive (%u)\n",
+            ns.connect_ms, ns.connects, ns.keepalive_ms, ns.keepalive);
+    MemStats mem;
+    weather_mem_stats(&mem);
+    fprintf(stderr, "arena: %u of %u bytes peak, %u last, %u failed\n",
+            mem.peak, mem.size, mem.last, mem.fails);
+    prof_print(stderr);
+    return ret == 0 ? 0 : 1;
+}